@@ -0,0 +1,149 @@
+#pragma once
+
+// Classic Aho-Corasick multi-pattern matcher over lowercase English letters.
+// Patterns and text are normalized to lower case; non-letters are skipped in
+// patterns and reset the automaton to the root in the text.
+
+#include <string>
+#include <vector>
+#include <queue>
+#include <algorithm> // for std::transform
+#include <map>       // To store matches
+#include <cctype>    // for tolower
+
+#include "SearchStats.h"
+
+namespace stringworks {
+
+inline std::string to_lower(std::string s) {//normalize to lower case
+    std::transform(s.begin(), s.end(), s.begin(),
+        [](unsigned char c) { return static_cast<char>(tolower(c)); }
+    );
+    return s;
+}
+
+class AhoCorasick {
+public:
+    static const int K = 26;
+
+    struct Vertex {
+        int next[K];
+        bool output = false;
+        int p = -1;
+        char pch;
+        int link = -1;
+        int go[K];
+
+        std::vector<int> pattern_indices;
+
+        Vertex(int p = -1, char ch = '$') : p(p), pch(ch) {
+            std::fill(std::begin(next), std::end(next), -1);
+            std::fill(std::begin(go), std::end(go), -1);
+        }
+    };
+
+private:
+    std::vector<Vertex> t = std::vector<Vertex>(1); // trie
+    std::vector<std::string> patterns; // Store patterns for output
+
+    void add_string(const std::string& s, int pattern_index) {
+        int v = 0;
+        for (char ch : s) {
+            int c = ch - 'a';
+            if (c < 0 || c >= K) continue; // Ignore non-alphabet chars
+
+            if (t[v].next[c] == -1) {
+                t[v].next[c] = t.size();
+                t.emplace_back(v, ch);
+            }
+            v = t[v].next[c];
+        }
+        t[v].output = true;
+        t[v].pattern_indices.push_back(pattern_index); // Store which pattern ends here
+    }
+
+    int get_link(int v) {
+        if (t[v].link == -1) {
+            if (v == 0 || t[v].p == 0)
+                t[v].link = 0;
+            else
+                t[v].link = go(get_link(t[v].p), t[v].pch);
+        }
+        return t[v].link;
+    }
+
+    int go(int v, char ch) {
+        int c = ch - 'a';
+        if (c < 0 || c >= K) return 0; // Non-alphabet char goes to root
+
+        if (t[v].go[c] == -1) {
+            if (t[v].next[c] != -1)
+                t[v].go[c] = t[v].next[c];
+            else
+                t[v].go[c] = v == 0 ? 0 : go(get_link(v), ch);
+        }
+        return t[v].go[c];
+    }
+
+public:
+    // Adds a pattern (normalized to lower case) and returns its index.
+    int addPattern(const std::string& p) {
+        int index = patterns.size();
+        patterns.push_back(to_lower(p)); // Store the normalized pattern
+        add_string(patterns.back(), index);
+        return index;
+    }
+
+    const std::vector<std::string>& getPatterns() const { return patterns; }
+
+    // Eagerly computes every failure link and go transition (BFS over the trie).
+    // Call once after the last addPattern; search() is then read-only on the trie.
+    void build() {
+        std::queue<int> q;
+        q.push(0);
+        while (!q.empty()) {
+            int v = q.front();
+            q.pop();
+            get_link(v); // Force calculation of link
+            for (int i = 0; i < K; ++i)
+                go(v, (char)('a' + i)); // Force calculation of go
+
+            for (int i = 0; i < K; ++i) {
+                if (t[v].next[i] != -1)
+                    q.push(t[v].next[i]);
+            }
+        }
+    }
+
+    // Reports all occurrences (including overlapping ones) of every pattern.
+    std::map<std::string, std::vector<int>> search(const std::string& rawText) {
+        SW_STATS_BEGIN();
+        std::string text = to_lower(rawText);
+        std::map<std::string, std::vector<int>> matches;
+        SW_STAT_ADD(bytesScanned, text.length());
+        int v = 0; // Start at the root
+
+        for (int i = 0; i < static_cast<int>(text.length()); ++i) {
+            char ch = text[i];
+            v = go(v, ch); // Transition in the automaton
+
+            // Check for outputs at this state
+            int current_v = v;
+            while (current_v != 0) {
+                if (t[current_v].output) {
+                    for (int p_idx : t[current_v].pattern_indices) {
+                        const std::string& pattern = patterns[p_idx];
+                        // Add match, (i - pattern.length() + 1) is the start index
+                        matches[pattern].push_back(i - static_cast<int>(pattern.length()) + 1);
+                    }
+                }
+                // Follow the failure link to check for suffixes
+                current_v = get_link(current_v);
+                SW_STAT_ADD(failureLinkHops, 1);
+            }
+        }
+        return matches;
+    }
+};
+
+} // namespace stringworks
@@ -0,0 +1,305 @@
+#pragma once
+
+// Entropy coding of BWT rows in independently decodable segments, so an
+// FM-index can rank inside a block after reading only a few segments.
+//
+// Each segment of segmentRows rows is coded as in bzip2: move-to-front over
+// the block alphabet (the MTF list is reset at every segment), runs of MTF
+// zeros written as bijective base-2 RUNA/RUNB digits, and the remaining MTF
+// indices k as symbol k + 1. One canonical Huffman code (lengths up to
+// MAX_CODE_LENGTH) covers every segment of the block.
+//
+// Encoded block layout (native byte order):
+//   code lengths  sigma + 1 bytes, one per symbol (RUNA, RUNB, MTF 1 .. sigma - 1)
+//   checkpoints   numSegments + 1 entries of { uint32 code offset, uint32 counts[sigma] },
+//                 counts of each alphabet byte in the rows before the segment
+//   code          segments, each starting on a byte boundary
+// The alphabet (sigma bytes, ascending) is not stored: it is the set of bytes
+// with a non-zero histogram entry. The `primary` row is a placeholder that is
+// coded as whatever keeps the MTF cheapest and is left out of every count.
+// Malformed input is reported with std::runtime_error.
+
+#include <string>
+#include <vector>
+#include <queue>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+namespace stringworks {
+
+const uint32_t DEFAULT_SEGMENT_ROWS = 8192;
+
+namespace bwt_detail {
+
+const int MAX_CODE_LENGTH = 15;
+const int RUNA = 0;
+const int RUNB = 1;
+
+class BitWriter {
+private:
+    std::string& out;
+    uint32_t acc = 0;
+    int bits = 0;
+
+public:
+    explicit BitWriter(std::string& out) : out(out) {}
+
+    void put(uint32_t code, int length) { // Most significant bit first
+        for (int i = length - 1; i >= 0; --i) {
+            acc = (acc << 1) | ((code >> i) & 1);
+            if (++bits == 8) {
+                out += (char)acc;
+                acc = 0;
+                bits = 0;
+            }
+        }
+    }
+    void flush() { // Pads the last byte with zeros
+        if (bits > 0) put(0, 8 - bits);
+    }
+};
+
+class BitReader {
+private:
+    const unsigned char* data;
+    size_t size;
+    size_t pos = 0;
+    int bit = 0;
+
+public:
+    BitReader(const unsigned char* data, size_t size) : data(data), size(size) {}
+
+    int next() {
+        if (pos >= size) throw std::runtime_error("bwt codec: truncated segment");
+        int value = (data[pos] >> (7 - bit)) & 1;
+        if (++bit == 8) {
+            bit = 0;
+            pos++;
+        }
+        return value;
+    }
+};
+
+// Huffman code lengths for freq, limited to MAX_CODE_LENGTH by flattening
+// the frequencies and retrying (as bzip2 does). Unused symbols get length 0.
+inline std::vector<uint8_t> huffmanLengths(std::vector<uint64_t> freq) {
+    std::vector<uint8_t> lengths(freq.size(), 0);
+    size_t used = 0;
+    for (uint64_t f : freq) used += f > 0;
+    if (used == 1) {
+        for (size_t s = 0; s < freq.size(); ++s) if (freq[s] > 0) lengths[s] = 1;
+        return lengths;
+    }
+    if (used == 0) return lengths;
+
+    while (true) {
+        // Nodes 0 .. size-1 are leaves; parent[] links the merged tree
+        std::vector<int> parent(2 * freq.size(), -1);
+        using Node = std::pair<uint64_t, int>; // (weight, node)
+        std::priority_queue<Node, std::vector<Node>, std::greater<Node>> heap;
+        for (size_t s = 0; s < freq.size(); ++s)
+            if (freq[s] > 0) heap.push({ freq[s], (int)s });
+        int next = freq.size();
+        while (heap.size() > 1) {
+            Node a = heap.top(); heap.pop();
+            Node b = heap.top(); heap.pop();
+            parent[a.second] = parent[b.second] = next;
+            heap.push({ a.first + b.first, next++ });
+        }
+
+        bool tooLong = false;
+        for (size_t s = 0; s < freq.size(); ++s) {
+            if (freq[s] == 0) continue;
+            int depth = 0;
+            for (int node = s; parent[node] >= 0; node = parent[node]) depth++;
+            lengths[s] = std::min(depth, 255);
+            tooLong = tooLong || depth > MAX_CODE_LENGTH;
+        }
+        if (!tooLong) return lengths;
+        for (uint64_t& f : freq)
+            if (f > 0) f = 1 + f / 2;
+    }
+}
+
+// Canonical codes: shorter codes first, ties in symbol order.
+inline std::vector<uint32_t> canonicalCodes(const std::vector<uint8_t>& lengths) {
+    std::vector<uint32_t> codes(lengths.size(), 0);
+    uint32_t code = 0;
+    for (int len = 1; len <= MAX_CODE_LENGTH; ++len) {
+        for (size_t s = 0; s < lengths.size(); ++s)
+            if (lengths[s] == len) codes[s] = code++;
+        code <<= 1;
+    }
+    return codes;
+}
+
+// MTF + RUNA/RUNB symbols of rows [begin, end).
+inline void segmentSymbols(const std::string& rows, size_t begin, size_t end, uint64_t primary,
+    const std::string& alphabet, std::vector<uint16_t>& symbols) {
+    std::string order = alphabet;
+    uint64_t zeros = 0;
+    auto flushZeros = [&]() {
+        while (zeros > 0) {
+            zeros--;
+            symbols.push_back((zeros & 1) ? RUNB : RUNA);
+            zeros >>= 1;
+        }
+    };
+    for (size_t r = begin; r < end; ++r) {
+        if (r == primary) { zeros++; continue; } // Placeholder: repeat the front byte
+        size_t k = order.find(rows[r]);
+        if (k == 0) { zeros++; continue; }
+        flushZeros();
+        symbols.push_back(k + 1);
+        char c = order[k];
+        order.erase(k, 1);
+        order.insert(order.begin(), c);
+    }
+    flushZeros();
+}
+
+} // namespace bwt_detail
+
+// Canonical Huffman decoder over the lengths stored at the start of a block.
+class HuffmanDecoder {
+private:
+    int counts[bwt_detail::MAX_CODE_LENGTH + 1] = {};
+    std::vector<uint16_t> symbols; // Sorted by (length, symbol)
+
+public:
+    HuffmanDecoder(const unsigned char* lengths, size_t count) {
+        using namespace bwt_detail;
+        int64_t left = 1; // Kraft budget
+        for (int len = 1; len <= MAX_CODE_LENGTH; ++len) {
+            for (size_t s = 0; s < count; ++s) {
+                if (lengths[s] > MAX_CODE_LENGTH) throw std::runtime_error("bwt codec: bad code length");
+                if (lengths[s] == len) {
+                    counts[len]++;
+                    symbols.push_back(s);
+                }
+            }
+            left = 2 * left - counts[len];
+            if (left < 0) throw std::runtime_error("bwt codec: over-subscribed code lengths");
+        }
+        if (symbols.empty()) throw std::runtime_error("bwt codec: empty code");
+    }
+
+    int decode(bwt_detail::BitReader& bits) const {
+        int code = 0, first = 0, index = 0;
+        for (int len = 1; len <= bwt_detail::MAX_CODE_LENGTH; ++len) {
+            code |= bits.next();
+            if (code - first < counts[len]) return symbols[index + code - first];
+            index += counts[len];
+            first = (first + counts[len]) << 1;
+            code <<= 1;
+        }
+        throw std::runtime_error("bwt codec: invalid code");
+    }
+};
+
+// Sizes of the metadata in front of the code, for a block with sigma distinct bytes.
+struct BWTBlockLayout {
+    uint32_t sigma = 0;
+    uint32_t numSegments = 0;
+    size_t entrySize = 0;         // One checkpoint entry
+    size_t checkpointsOffset = 0; // = sigma + 1 code length bytes
+    size_t codeOffset = 0;        // After numSegments + 1 checkpoint entries
+
+    BWTBlockLayout(uint32_t sigma, uint64_t rows, uint32_t segmentRows)
+        : sigma(sigma), numSegments((uint32_t)((rows + segmentRows - 1) / segmentRows)),
+          entrySize(4 * ((size_t)sigma + 1)), checkpointsOffset((size_t)sigma + 1),
+          codeOffset(checkpointsOffset + ((size_t)numSegments + 1) * entrySize) {}
+};
+
+/**
+ * Encodes BWT rows (row `primary` is a placeholder) into the block layout
+ * described above. Returns the encoded bytes.
+ */
+inline std::string encodeBWTBlock(const std::string& rows, uint64_t primary, uint32_t segmentRows = DEFAULT_SEGMENT_ROWS) {
+    using namespace bwt_detail;
+    if (segmentRows == 0) throw std::invalid_argument("bwt codec: segmentRows must be positive");
+
+    uint32_t histogram[256] = {};
+    for (size_t r = 0; r < rows.size(); ++r)
+        if (r != primary) histogram[(unsigned char)rows[r]]++;
+    std::string alphabet;
+    int slot[256];
+    for (int c = 0; c < 256; ++c) {
+        slot[c] = histogram[c] > 0 ? (int)alphabet.size() : -1;
+        if (histogram[c] > 0) alphabet += (char)c;
+    }
+    if (alphabet.empty()) alphabet += '\0'; // Only the placeholder row
+    BWTBlockLayout layout(alphabet.size(), rows.size(), segmentRows);
+
+    // Symbols of every segment, then one code for all of them
+    std::vector<std::vector<uint16_t>> segments(layout.numSegments);
+    std::vector<uint64_t> freq(layout.sigma + 1, 0);
+    for (uint32_t s = 0; s < layout.numSegments; ++s) {
+        size_t begin = (size_t)s * segmentRows;
+        segmentSymbols(rows, begin, std::min(rows.size(), begin + segmentRows), primary, alphabet, segments[s]);
+        for (uint16_t symbol : segments[s]) freq[symbol]++;
+    }
+    std::vector<uint8_t> lengths = huffmanLengths(freq);
+    std::vector<uint32_t> codes = canonicalCodes(lengths);
+
+    std::string code;
+    std::vector<uint32_t> offsets;
+    for (uint32_t s = 0; s < layout.numSegments; ++s) {
+        offsets.push_back(code.size());
+        BitWriter bits(code);
+        for (uint16_t symbol : segments[s]) bits.put(codes[symbol], lengths[symbol]);
+        bits.flush();
+    }
+    offsets.push_back(code.size());
+
+    std::string out(lengths.begin(), lengths.end());
+    std::vector<uint32_t> counts(layout.sigma, 0);
+    for (uint32_t s = 0; s <= layout.numSegments; ++s) {
+        out.append(reinterpret_cast<const char*>(&offsets[s]), 4);
+        out.append(reinterpret_cast<const char*>(counts.data()), 4 * counts.size());
+        size_t begin = (size_t)s * segmentRows;
+        for (size_t r = begin; r < std::min(rows.size(), begin + segmentRows); ++r)
+            if (r != primary) counts[slot[(unsigned char)rows[r]]]++;
+    }
+    out += code;
+    return out;
+}
+
+/**
+ * Decodes one segment of rowCount rows from its code bytes. The placeholder
+ * row, if it falls in this segment, comes back as an arbitrary alphabet byte.
+ */
+inline std::string decodeBWTSegment(const unsigned char* code, size_t size, size_t rowCount,
+    const std::string& alphabet, const HuffmanDecoder& decoder) {
+    using namespace bwt_detail;
+    bwt_detail::BitReader bits(code, size);
+    std::string order = alphabet;
+    std::string out;
+    out.reserve(rowCount);
+    uint64_t run = 0, weight = 1;
+    while (out.size() + run < rowCount) {
+        int symbol = decoder.decode(bits);
+        if (symbol == RUNA || symbol == RUNB) {
+            if (weight > rowCount) throw std::runtime_error("bwt codec: run too long");
+            run += weight << symbol;
+            weight <<= 1;
+            continue;
+        }
+        out.append(run, order[0]);
+        run = 0;
+        weight = 1;
+        size_t k = symbol - 1;
+        if (k >= order.size()) throw std::runtime_error("bwt codec: bad MTF index");
+        char c = order[k];
+        order.erase(k, 1);
+        order.insert(order.begin(), c);
+        out += c;
+    }
+    if (out.size() + run != rowCount) throw std::runtime_error("bwt codec: segment length mismatch");
+    out.append(run, order[0]);
+    return out;
+}
+
+} // namespace stringworks
@@ -0,0 +1,363 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <memory>
+#include <cmath>
+#include <cctype>
+#include <cstdlib>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#define STRINGWORKS_BENCH_FORK 1
+#endif
+
+#include "HybridSearch.h"
+#include "AhoCorasick.h"
+#include "SuffixArrayDC.h"
+#include "SuffixArrayQuery.h"
+#include "LZFactorization.h"
+#include "TextSimilarity.h"
+
+using namespace std;
+using namespace stringworks;
+
+// Reproducible benchmark for the four engines over synthetic inputs.
+//
+// Every (engine, generator, size) case runs in its own child process so the
+// reported peak RSS belongs to that case alone. Inputs are generated from a
+// fixed seed, so two runs of the same build see identical data.
+
+struct BenchOptions {
+    vector<string> engines = { "hybrid", "aho-corasick", "suffix-array", "sa-query", "lz77", "lz77-factorize", "similarity" };
+    vector<string> generators = { "random", "low-entropy", "periodic", "dna", "english" };
+    size_t minSize = 1 << 10;      // 1 KB
+    size_t maxSize = 4 << 20;      // 4 MB by default; up to 1 GB with --max-size 1G
+    int queries = 10;
+    double timeBudget = 10.0;      // Seconds per case before larger sizes are skipped
+    unsigned seed = 42;
+    bool stats = false;            // Per-query SearchStats JSON on stderr
+};
+
+struct BenchResult {
+    int queries = 0;
+    bool outOfBudget = false;
+    double p50 = 0, p90 = 0, p99 = 0; // Milliseconds
+    double throughput = 0;            // MB/s of input per query, or patterns/s
+    bool perPattern = false;          // throughput counts patterns, not input bytes
+};
+
+// --- Synthetic Generators ---
+
+string generateText(const string& kind, size_t n, unsigned seed) {
+    mt19937_64 rng(seed);
+    string s;
+    s.reserve(n);
+
+    if (kind == "random") {
+        uniform_int_distribution<int> ch(32, 126); // Printable ASCII
+        while (s.size() < n) s += (char)ch(rng);
+    }
+    else if (kind == "low-entropy") {
+        discrete_distribution<int> ch({ 90, 7, 3 });
+        while (s.size() < n) s += (char)('a' + ch(rng));
+    }
+    else if (kind == "periodic") {
+        uniform_int_distribution<int> ch('a', 'z');
+        string period;
+        for (int i = 0; i < 17; ++i) period += (char)ch(rng);
+        while (s.size() < n) s += period[s.size() % period.size()];
+    }
+    else if (kind == "dna") {
+        uniform_int_distribution<int> ch(0, 3);
+        while (s.size() < n) s += "ACGT"[ch(rng)];
+    }
+    else if (kind == "english") {
+        static const vector<string> words = {
+            "the", "of", "and", "to", "a", "in", "is", "that", "for", "it", "as", "was", "with", "be",
+            "by", "on", "not", "he", "this", "are", "or", "his", "from", "at", "which", "but", "have",
+            "an", "had", "they", "you", "were", "their", "one", "all", "we", "can", "her", "has", "there",
+            "been", "if", "more", "when", "will", "would", "who", "so", "no", "string", "search", "text"
+        };
+        // Zipf-like: weight of the i-th word is 1 / (i + 1)
+        vector<double> weights;
+        for (size_t i = 0; i < words.size(); ++i) weights.push_back(1.0 / (i + 1));
+        discrete_distribution<size_t> word(weights.begin(), weights.end());
+        uniform_int_distribution<int> sentence(0, 11);
+        while (s.size() < n) {
+            s += words[word(rng)];
+            s += sentence(rng) == 0 ? ". " : " ";
+        }
+    }
+    s.resize(n);
+    return s;
+}
+
+// --- Engine Cases ---
+
+// Prepares untimed state for one engine over `text` and returns the timed query.
+// Engines whose query is a batch of lookups set patternsPerQuery to the batch size.
+function<size_t(mt19937_64&)> prepareEngine(const string& engine, const string& text, size_t& patternsPerQuery) {
+    patternsPerQuery = 0;
+    auto samplePattern = [&text](mt19937_64& rng, size_t len) {
+        len = min(len, text.size());
+        uniform_int_distribution<size_t> pos(0, text.size() - len);
+        return text.substr(pos(rng), len);
+    };
+
+    if (engine == "hybrid") {
+        int alphabetSize = 0;
+        bool seen[256] = {};
+        for (unsigned char c : text)
+            if (!seen[c]) { seen[c] = true; alphabetSize++; }
+        return [=, &text](mt19937_64& rng) {
+            return adaptiveStringSearch(text, samplePattern(rng, 16), alphabetSize).size();
+        };
+    }
+    if (engine == "aho-corasick") {
+        auto automaton = make_shared<AhoCorasick>();
+        mt19937_64 patternRng(7);
+        for (int i = 0; i < 64; ++i) automaton->addPattern(samplePattern(patternRng, 8));
+        automaton->build();
+        return [automaton, &text](mt19937_64&) {
+            return automaton->search(text).size();
+        };
+    }
+    if (engine == "suffix-array") {
+        return [&text](mt19937_64&) {
+            string withSentinel = text + "$";
+            vector<int> suffixArr = buildSuffixArrayDC(withSentinel);
+            vector<int> lcpArr = buildLCPArray(withSentinel, suffixArr);
+            return buildBWT(withSentinel, suffixArr).size() + lcpArr.size();
+        };
+    }
+    if (engine == "sa-query") {
+        // The suffix array is built once (by prefix doubling, so periodic text
+        // reaches the large sizes); each query is a batch of 1000 counts
+        struct Prebuilt {
+            vector<int> suffixArr, lcpArr;
+            unique_ptr<SuffixArrayIndex> index;
+        };
+        patternsPerQuery = 1000;
+        auto prebuilt = make_shared<Prebuilt>();
+        prebuilt->suffixArr = buildSuffixArrayDoubling(text);
+        prebuilt->lcpArr = buildLCPArray(text, prebuilt->suffixArr);
+        prebuilt->index = make_unique<SuffixArrayIndex>(text, prebuilt->suffixArr, prebuilt->lcpArr);
+        return [=](mt19937_64& rng) {
+            vector<string> batch;
+            for (size_t i = 0; i < patternsPerQuery; ++i) batch.push_back(samplePattern(rng, 4 + i % 29));
+            size_t total = 0;
+            for (const PatternMatches& m : prebuilt->index->queryBatch(batch, false)) total += m.count;
+            return total;
+        };
+    }
+    if (engine == "lz77") {
+        // End to end: SA, LCP, factorization and encoding
+        return [&text](mt19937_64&) {
+            return lz77Compress(text).size();
+        };
+    }
+    if (engine == "lz77-factorize") {
+        // Factorization only; SA and LCP are built once outside the timed query
+        auto suffixArr = make_shared<vector<int>>(buildSuffixArrayDoubling(text));
+        auto lcpArr = make_shared<vector<int>>(buildLCPArray(text, *suffixArr));
+        return [suffixArr, lcpArr, &text](mt19937_64&) {
+            return lz77Factorize(text, *suffixArr, *lcpArr).size();
+        };
+    }
+    if (engine == "similarity") {
+        return [&text](mt19937_64&) {
+            string_view all(text);
+            return (size_t)findLongestMatch(all.substr(0, all.size() / 2), all.substr(all.size() / 2));
+        };
+    }
+    return nullptr;
+}
+
+double percentile(const vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = (size_t)ceil(p * sorted.size());
+    return sorted[min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+BenchResult runCase(const string& engine, const string& generator, size_t size, const BenchOptions& options) {
+    BenchResult result;
+    string text = generateText(generator, size, options.seed);
+    size_t patternsPerQuery = 0;
+    function<size_t(mt19937_64&)> query = prepareEngine(engine, text, patternsPerQuery);
+    mt19937_64 rng(options.seed);
+
+    static volatile size_t sink = 0; // Keeps query results observable
+    vector<double> latencies;
+    double total = 0;
+    for (int i = 0; i < options.queries; ++i) {
+        SearchStats stats;
+        auto start = chrono::steady_clock::now();
+        {
+            StatsScope scope(stats, engine);
+            sink = sink + query(rng);
+        }
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        if (options.stats) {
+            cerr << "{\"generator\":\"" << generator << "\",\"size\":" << size << ",\"query\":" << i
+                 << ",\"stats\":" << stats.toJson() << "}" << endl;
+        }
+        latencies.push_back(ms);
+        total += ms;
+        if (total > options.timeBudget * 1000 && i + 1 < options.queries) {
+            result.outOfBudget = true;
+            break;
+        }
+    }
+
+    sort(latencies.begin(), latencies.end());
+    result.queries = latencies.size();
+    result.p50 = percentile(latencies, 0.50);
+    result.p90 = percentile(latencies, 0.90);
+    result.p99 = percentile(latencies, 0.99);
+    double meanSeconds = total / latencies.size() / 1000;
+    result.perPattern = patternsPerQuery > 0;
+    if (meanSeconds <= 0) result.throughput = 0;
+    else if (result.perPattern) result.throughput = patternsPerQuery / meanSeconds;
+    else result.throughput = size / meanSeconds / 1e6;
+    return result;
+}
+
+// Runs one case, isolated in a child process where available.
+// Returns false if the case crashed or was killed; peakRssKB is -1 when unknown.
+bool runIsolated(const string& engine, const string& generator, size_t size,
+    const BenchOptions& options, BenchResult& result, long& peakRssKB) {
+    peakRssKB = -1;
+#ifdef STRINGWORKS_BENCH_FORK
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    cout.flush();
+
+    pid_t child = fork();
+    if (child == 0) {
+        close(fds[0]);
+        // Hard stop for a single query that blows far past the budget
+        alarm((unsigned)(options.timeBudget * 10) + 1);
+        BenchResult r = runCase(engine, generator, size, options);
+        ssize_t written = write(fds[1], &r, sizeof(r));
+        _exit(written == (ssize_t)sizeof(r) ? 0 : 1);
+    }
+    close(fds[1]);
+    ssize_t got = child > 0 ? read(fds[0], &result, sizeof(result)) : -1;
+    close(fds[0]);
+    if (child < 0) return false;
+
+    int status = 0;
+    struct rusage usage;
+    if (wait4(child, &status, 0, &usage) < 0) return false;
+    peakRssKB = usage.ru_maxrss;
+#ifdef __APPLE__
+    peakRssKB /= 1024; // Bytes on macOS
+#endif
+    return got == (ssize_t)sizeof(result) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#else
+    result = runCase(engine, generator, size, options);
+    return true;
+#endif
+}
+
+// --- Command Line ---
+
+size_t parseSize(const string& s) {
+    size_t value = strtoull(s.c_str(), nullptr, 10);
+    switch (s.empty() ? ' ' : toupper(s.back())) {
+    case 'K': return value << 10;
+    case 'M': return value << 20;
+    case 'G': return value << 30;
+    default: return value;
+    }
+}
+
+vector<string> splitList(const string& s) {
+    vector<string> items;
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t comma = s.find(',', start);
+        if (comma == string::npos) comma = s.size();
+        if (comma > start) items.push_back(s.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return items;
+}
+
+string formatSize(size_t n) {
+    if (n >= (1u << 30) && n % (1u << 30) == 0) return to_string(n >> 30) + "G";
+    if (n >= (1u << 20) && n % (1u << 20) == 0) return to_string(n >> 20) + "M";
+    if (n >= (1u << 10) && n % (1u << 10) == 0) return to_string(n >> 10) + "K";
+    return to_string(n);
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        string value = i + 1 < argc ? argv[i + 1] : "";
+        if (arg == "--engines") { options.engines = splitList(value); ++i; }
+        else if (arg == "--generators") { options.generators = splitList(value); ++i; }
+        else if (arg == "--min-size") { options.minSize = max<size_t>(1, parseSize(value)); ++i; }
+        else if (arg == "--max-size") { options.maxSize = parseSize(value); ++i; }
+        else if (arg == "--queries") { options.queries = max(1, atoi(value.c_str())); ++i; }
+        else if (arg == "--time-budget") { options.timeBudget = atof(value.c_str()); ++i; }
+        else if (arg == "--seed") { options.seed = (unsigned)strtoul(value.c_str(), nullptr, 10); ++i; }
+        else if (arg == "--stats") options.stats = true;
+        else {
+            cout << "Usage: " << argv[0] << " [--engines hybrid,aho-corasick,suffix-array,sa-query,lz77,lz77-factorize,similarity]\n"
+                 << "       [--generators random,low-entropy,periodic,dna,english]\n"
+                 << "       [--min-size 1K] [--max-size 4M] [--queries 10] [--time-budget 10] [--seed 42]\n"
+                 << "       [--stats]" << endl;
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    if (options.stats && !statsEnabled) {
+        cout << "--stats needs a build with -DSTRINGWORKS_STATS=ON" << endl;
+        return 1;
+    }
+    const vector<string> knownEngines = BenchOptions().engines;
+    for (const string& engine : options.engines) {
+        if (find(knownEngines.begin(), knownEngines.end(), engine) == knownEngines.end()) {
+            cout << "Unknown engine: " << engine << endl;
+            return 1;
+        }
+    }
+
+    cout << left << setw(16) << "engine" << setw(13) << "generator" << right << setw(6) << "size"
+         << setw(9) << "queries" << setw(12) << "p50 ms" << setw(12) << "p90 ms" << setw(12) << "p99 ms"
+         << setw(20) << "throughput" << setw(12) << "peak RSS MB" << endl;
+    cout << fixed << setprecision(3);
+
+    for (const string& engine : options.engines) {
+        for (const string& generator : options.generators) {
+            // Sizes grow 4x per step; a case that runs out of budget ends the sweep
+            for (size_t size = options.minSize; size <= options.maxSize; size *= 4) {
+                BenchResult result;
+                long peakRssKB = -1;
+                bool ok = runIsolated(engine, generator, size, options, result, peakRssKB);
+
+                cout << left << setw(16) << engine << setw(13) << generator << right << setw(6) << formatSize(size);
+                if (!ok) {
+                    cout << "  killed or timed out; skipping larger sizes" << endl;
+                    break;
+                }
+                cout << setw(9) << result.queries << setw(12) << result.p50 << setw(12) << result.p90
+                     << setw(12) << result.p99 << setw(14) << result.throughput
+                     << (result.perPattern ? " pat/s" : "  MB/s");
+                if (peakRssKB >= 0) cout << setw(12) << peakRssKB / 1024.0;
+                else cout << setw(12) << "n/a";
+                cout << (result.outOfBudget ? "  (time budget hit; skipping larger sizes)" : "") << endl;
+                if (result.outOfBudget) break;
+            }
+        }
+    }
+    return 0;
+}
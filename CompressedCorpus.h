@@ -0,0 +1,457 @@
+#pragma once
+
+// Block-compressed corpus that can be searched without full decompression.
+//
+// The text is cut into blocks of blockSize bytes; each block also stores the
+// next `overlap` bytes so a match that crosses a block boundary is still
+// inside one block. Every block is stored as its BWT (with an implicit
+// sentinel smaller than every byte), entropy coded by BWTCodec.h in segments
+// of segmentRows rows, with sampled Occ checkpoints (the count of every byte
+// before each segment) written at pack time. The directory at the end of the
+// file keeps each block's byte histogram (from which C[] is derived) and
+// sentinel row.
+//
+// A query
+//   1. skips every block whose histogram lacks one of the pattern's bytes
+//      without reading it,
+//   2. runs FM-index backward search on the rest: each rank reads one pair of
+//      checkpoints and decodes the one segment it falls in, so only the
+//      segments the search touches are read,
+//   3. inverts the BWT (LF mapping) only for blocks with hits and runs
+//      kmpSearch on them to recover positions.
+//
+// File layout (native byte order, like the external SA files):
+//   header:    "SWFM", version, blockSize, overlap, segmentRows, totalLength, numBlocks, directoryOffset
+//   payloads:  per block, encodeBWTBlock output (code lengths, checkpoints, segments)
+//   directory: per block, BlockInfo
+// I/O and format errors, including blocks whose contents disagree with their
+// checkpoints or histogram, are reported with std::runtime_error.
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <algorithm>
+#include <stdexcept>
+
+#include "SuffixArrayDC.h"
+#include "HybridSearch.h"
+#include "BWTCodec.h"
+
+namespace stringworks {
+
+struct CorpusBuildOptions {
+    uint32_t blockSize = 256 << 10;              // Larger blocks compress better
+    uint32_t overlap = 255;                      // Longest supported pattern is overlap + 1
+    uint32_t segmentRows = DEFAULT_SEGMENT_ROWS; // Rows per checkpoint and decodable segment
+};
+
+struct CorpusSearchResult {
+    std::vector<int64_t> positions;  // Ascending offsets into the original text
+    size_t blocksSkipped = 0;   // Rejected by the histogram, never read
+    size_t blocksRead = 0;      // Backward-searched on the compressed BWT
+    size_t blocksDecoded = 0;   // Had hits, so were inverted and scanned
+    size_t bytesRead = 0;       // Compressed payload bytes read from disk
+};
+
+namespace corpus_detail {
+
+const char MAGIC[4] = { 'S', 'W', 'F', 'M' };
+const uint32_t VERSION = 2;
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t blockSize;
+    uint32_t overlap;
+    uint32_t segmentRows;
+    uint32_t reserved;
+    uint64_t totalLength;
+    uint64_t numBlocks;
+    uint64_t directoryOffset;
+};
+
+struct BlockInfo {
+    uint64_t textStart;     // Offset of the block in the original text
+    uint32_t length;        // Block bytes, including the overlap
+    uint32_t ownLength;     // Matches must start in [0, ownLength) to belong to this block
+    uint32_t primary;       // BWT row holding the sentinel
+    uint32_t reserved;
+    uint64_t payloadOffset;
+    uint64_t payloadSize;
+    uint32_t histogram[256];
+};
+
+inline void writeOrThrow(FILE* f, const void* data, size_t size) {
+    if (size > 0 && fwrite(data, 1, size, f) != size) throw std::runtime_error("compressed corpus: write failed");
+}
+
+inline void readOrThrow(FILE* f, void* data, size_t size) {
+    if (size > 0 && fread(data, 1, size, f) != size) throw std::runtime_error("compressed corpus: truncated file");
+}
+
+[[noreturn]] inline void corrupt(const char* what) {
+    throw std::runtime_error(std::string("compressed corpus: corrupt block (") + what + ")");
+}
+
+// C[c] = first BWT row whose suffix starts with byte c. Rows are in the
+// signed-char order of isSmaller, and row 0 is the sentinel suffix.
+inline void buildC(const uint32_t histogram[256], uint32_t C[256]) {
+    uint32_t total = 1;
+    for (int v = -128; v <= 127; ++v) {
+        unsigned char c = (unsigned char)(char)v;
+        C[c] = total;
+        total += histogram[c];
+    }
+}
+
+// BWT rows of one block: row 0 is the sentinel suffix, row r > 0 is suffixArr[r - 1].
+// The sentinel's own row is a placeholder that the codec leaves out of every count.
+inline std::string blockBWT(const std::string& block, uint32_t& primary) {
+    std::vector<int> suffixArr = buildSuffixArrayDoubling(block);
+    std::string rows(block.size() + 1, '\0');
+    rows[0] = block.empty() ? '\0' : block.back();
+    primary = 0;
+    for (size_t r = 1; r <= block.size(); ++r) {
+        int pos = suffixArr[r - 1];
+        if (pos == 0) primary = r;
+        else rows[r] = block[pos - 1];
+    }
+    return rows;
+}
+
+// Lazy reader over one encoded block. Checkpoints and segments are read from
+// the file only when a rank needs them, checked against each other and the
+// histogram, and cached for the rest of the query.
+class BlockReader {
+private:
+    struct Segment {
+        std::vector<uint32_t> before; // Count of each alphabet byte before the segment
+        std::string rows;
+    };
+
+    FILE* file;
+    const BlockInfo& info;
+    uint32_t segmentRows;
+    size_t& bytesRead;
+    uint64_t rows;
+    std::string alphabet;
+    int slot[256];
+    BWTBlockLayout layout;
+    std::unique_ptr<HuffmanDecoder> decoder;
+    std::unordered_map<uint32_t, Segment> cache;
+
+    static std::string alphabetOf(const BlockInfo& info) {
+        std::string bytes;
+        for (int c = 0; c < 256; ++c)
+            if (info.histogram[c] > 0) bytes += (char)c;
+        return bytes;
+    }
+
+    void readAt(uint64_t offset, void* data, size_t size) {
+        if (fseek(file, (long)(info.payloadOffset + offset), SEEK_SET) != 0)
+            throw std::runtime_error("compressed corpus: seek failed");
+        readOrThrow(file, data, size);
+        bytesRead += size;
+    }
+
+    // Decodes segment s and checks it against its two checkpoints.
+    const Segment& segment(uint32_t s) {
+        auto it = cache.find(s);
+        if (it != cache.end()) return it->second;
+        if (s >= layout.numSegments) corrupt("segment index");
+
+        // Checkpoints s and s + 1 are adjacent: { code offset, counts[sigma] } each
+        std::vector<uint32_t> entries(2 * ((size_t)layout.sigma + 1));
+        readAt(layout.checkpointsOffset + (uint64_t)s * layout.entrySize, entries.data(), 2 * layout.entrySize);
+        const uint32_t* first = entries.data();
+        const uint32_t* second = first + layout.sigma + 1;
+        if (first[0] > second[0] || second[0] > info.payloadSize - layout.codeOffset) corrupt("segment offsets");
+        if (s == 0 && first[0] != 0) corrupt("first segment offset");
+        for (uint32_t k = 0; k < layout.sigma; ++k) {
+            uint32_t total = info.histogram[(unsigned char)alphabet[k]];
+            if (first[1 + k] > second[1 + k] || second[1 + k] > total) corrupt("checkpoint counts");
+            if (s == 0 && first[1 + k] != 0) corrupt("first checkpoint");
+            if (s + 1 == layout.numSegments && second[1 + k] != total) corrupt("last checkpoint");
+        }
+
+        std::vector<unsigned char> code(second[0] - first[0]);
+        readAt(layout.codeOffset + first[0], code.data(), code.size());
+        uint64_t begin = (uint64_t)s * segmentRows;
+        size_t count = std::min<uint64_t>(segmentRows, rows - begin);
+        Segment seg;
+        seg.before.assign(first + 1, first + 1 + layout.sigma);
+        seg.rows = decodeBWTSegment(code.data(), code.size(), count, alphabet, *decoder);
+
+        std::vector<uint32_t> seen(layout.sigma, 0);
+        for (size_t r = 0; r < count; ++r)
+            if (begin + r != info.primary) seen[slot[(unsigned char)seg.rows[r]]]++;
+        for (uint32_t k = 0; k < layout.sigma; ++k)
+            if (seg.before[k] + seen[k] != second[1 + k]) corrupt("segment does not match its checkpoints");
+
+        return cache.emplace(s, std::move(seg)).first->second;
+    }
+
+public:
+    BlockReader(FILE* file, const BlockInfo& info, uint32_t segmentRows, size_t& bytesRead)
+        : file(file), info(info), segmentRows(segmentRows), bytesRead(bytesRead), rows((uint64_t)info.length + 1),
+          alphabet(alphabetOf(info)), layout(alphabet.size(), rows, segmentRows) {
+        std::fill(std::begin(slot), std::end(slot), -1);
+        for (size_t k = 0; k < alphabet.size(); ++k) slot[(unsigned char)alphabet[k]] = k;
+        if (info.payloadSize < layout.codeOffset) corrupt("payload smaller than its checkpoints");
+
+        std::vector<unsigned char> lengths(layout.checkpointsOffset);
+        readAt(0, lengths.data(), lengths.size());
+        decoder = std::make_unique<HuffmanDecoder>(lengths.data(), lengths.size());
+    }
+
+    uint64_t rowCount() const { return rows; }
+
+    // Occurrences of c in rows [0, row), not counting the sentinel placeholder.
+    uint32_t rank(unsigned char c, uint64_t row) {
+        if (slot[c] < 0 || row == 0) return 0;
+        if (row >= rows) return info.histogram[c];
+        uint32_t s = row / segmentRows;
+        const Segment& seg = segment(s);
+        uint64_t begin = (uint64_t)s * segmentRows;
+        uint32_t result = seg.before[slot[c]];
+        for (uint64_t r = begin; r < row; ++r)
+            result += seg.rows[r - begin] == (char)c && r != info.primary;
+        return result;
+    }
+
+    // Every row in order; the placeholder row holds an arbitrary byte.
+    std::string allRows() {
+        std::string out;
+        out.reserve(rows);
+        for (uint32_t s = 0; s < layout.numSegments; ++s) out += segment(s).rows;
+        return out;
+    }
+};
+
+} // namespace corpus_detail
+
+/**
+ * Compresses everything readable from `in` into a corpus file at `path`.
+ * The input is streamed one block (plus overlap) at a time.
+ */
+inline void writeCompressedCorpus(std::istream& in, const std::string& path,
+    const CorpusBuildOptions& options = CorpusBuildOptions()) {
+    using namespace corpus_detail;
+    if (options.blockSize == 0) throw std::invalid_argument("compressed corpus: blockSize must be positive");
+    if (options.segmentRows == 0) throw std::invalid_argument("compressed corpus: segmentRows must be positive");
+
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) throw std::runtime_error("cannot create " + path);
+
+    try {
+        Header header = {};
+        memcpy(header.magic, MAGIC, 4);
+        header.version = VERSION;
+        header.blockSize = options.blockSize;
+        header.overlap = options.overlap;
+        header.segmentRows = options.segmentRows;
+        writeOrThrow(f, &header, sizeof(header));
+
+        std::vector<BlockInfo> directory;
+        size_t span = (size_t)options.blockSize + options.overlap;
+        std::string window; // Current block plus one byte of lookahead
+        auto readAhead = [&]() {
+            size_t have = window.size();
+            if (have > span) return;
+            window.resize(span + 1);
+            in.read(&window[have], span + 1 - have);
+            window.resize(have + in.gcount());
+        };
+
+        uint64_t offset = sizeof(header);
+        uint64_t textStart = 0;
+        readAhead();
+        while (!window.empty()) {
+            // The last block owns everything left, including what would be overlap
+            bool last = window.size() <= span;
+            std::string block = last ? window : window.substr(0, span);
+
+            BlockInfo info = {};
+            info.textStart = textStart;
+            info.length = block.size();
+            info.ownLength = last ? block.size() : options.blockSize;
+            for (unsigned char c : block) info.histogram[c]++;
+
+            std::string rows = blockBWT(block, info.primary);
+            std::string payload = encodeBWTBlock(rows, info.primary, options.segmentRows);
+            info.payloadOffset = offset;
+            info.payloadSize = payload.size();
+            writeOrThrow(f, payload.data(), payload.size());
+            offset += payload.size();
+            directory.push_back(info);
+
+            if (last) break;
+            window.erase(0, options.blockSize);
+            textStart += options.blockSize;
+            readAhead();
+        }
+
+        header.totalLength = directory.empty() ? 0 : directory.back().textStart + directory.back().length;
+        header.numBlocks = directory.size();
+        header.directoryOffset = offset;
+        writeOrThrow(f, directory.data(), directory.size() * sizeof(BlockInfo));
+        if (fseek(f, 0, SEEK_SET) != 0) throw std::runtime_error("compressed corpus: seek failed");
+        writeOrThrow(f, &header, sizeof(header));
+        if (fclose(f) != 0) { f = nullptr; throw std::runtime_error("compressed corpus: close failed"); }
+    }
+    catch (...) {
+        if (f) fclose(f);
+        throw;
+    }
+}
+
+class CompressedCorpus {
+private:
+    FILE* file = nullptr;
+    corpus_detail::Header header = {};
+    std::vector<corpus_detail::BlockInfo> directory;
+
+    // Directory-level checks; block contents are checked as they are decoded.
+    void validate(uint64_t fileSize) const {
+        using namespace corpus_detail;
+        if (header.blockSize == 0 || header.segmentRows == 0)
+            throw std::runtime_error("compressed corpus: bad header");
+        if (header.directoryOffset < sizeof(Header)
+            || header.directoryOffset + header.numBlocks * sizeof(BlockInfo) != fileSize)
+            throw std::runtime_error("compressed corpus: directory does not fit the file");
+
+        uint64_t textStart = 0;
+        for (size_t b = 0; b < directory.size(); ++b) {
+            const BlockInfo& info = directory[b];
+            bool last = b + 1 == directory.size();
+            uint64_t histogramTotal = 0;
+            for (uint32_t count : info.histogram) histogramTotal += count;
+            if (info.textStart != textStart || info.length == 0
+                || (uint64_t)info.length > (uint64_t)header.blockSize + header.overlap
+                || info.ownLength != (last ? info.length : header.blockSize)
+                || info.primary == 0 || info.primary > info.length || histogramTotal != info.length)
+                throw std::runtime_error("compressed corpus: bad block metadata");
+            if (info.payloadOffset < sizeof(Header) || info.payloadOffset > header.directoryOffset
+                || info.payloadSize > header.directoryOffset - info.payloadOffset)
+                throw std::runtime_error("compressed corpus: block payload outside the file");
+            textStart += info.ownLength;
+        }
+        uint64_t total = directory.empty() ? 0 : directory.back().textStart + directory.back().length;
+        if (header.totalLength != total) throw std::runtime_error("compressed corpus: bad total length");
+    }
+
+    // Inverts the BWT of one block back to its text (LF mapping from row 0).
+    std::string decodeBlock(const corpus_detail::BlockInfo& info, corpus_detail::BlockReader& reader) const {
+        using namespace corpus_detail;
+        std::string rows = reader.allRows();
+
+        // Every segment matched its checkpoints and the last checkpoint matched
+        // the histogram, so LF below stays inside the rows.
+        uint32_t C[256];
+        buildC(info.histogram, C);
+        std::vector<uint32_t> lf(rows.size(), 0);
+        uint32_t seen[256] = {};
+        for (size_t r = 0; r < rows.size(); ++r) {
+            if (r == info.primary) continue;
+            unsigned char c = rows[r];
+            lf[r] = C[c] + seen[c]++;
+        }
+
+        std::string text(info.length, '\0');
+        uint32_t r = 0; // Sentinel suffix: its BWT char is the last text byte
+        for (int64_t k = (int64_t)info.length - 1; k >= 0; --k) {
+            if (r == info.primary) corrupt("BWT cycle ends early");
+            text[k] = rows[r];
+            r = lf[r];
+        }
+        return text;
+    }
+
+public:
+    explicit CompressedCorpus(const std::string& path) {
+        using namespace corpus_detail;
+        file = fopen(path.c_str(), "rb");
+        if (!file) throw std::runtime_error("cannot open " + path);
+        try {
+            if (fseek(file, 0, SEEK_END) != 0) throw std::runtime_error("compressed corpus: seek failed");
+            long fileSize = ftell(file);
+            if (fileSize < 0 || fseek(file, 0, SEEK_SET) != 0) throw std::runtime_error("compressed corpus: seek failed");
+            readOrThrow(file, &header, sizeof(header));
+            if (memcmp(header.magic, MAGIC, 4) != 0 || header.version != VERSION)
+                throw std::runtime_error(path + " is not a compressed corpus");
+            if (header.directoryOffset > (uint64_t)fileSize
+                || header.numBlocks > ((uint64_t)fileSize - header.directoryOffset) / sizeof(BlockInfo))
+                throw std::runtime_error("compressed corpus: directory does not fit the file");
+            directory.resize(header.numBlocks);
+            if (fseek(file, (long)header.directoryOffset, SEEK_SET) != 0) throw std::runtime_error("compressed corpus: seek failed");
+            readOrThrow(file, directory.data(), directory.size() * sizeof(BlockInfo));
+            validate(fileSize);
+        }
+        catch (...) {
+            fclose(file);
+            throw;
+        }
+    }
+    ~CompressedCorpus() { if (file) fclose(file); }
+    CompressedCorpus(const CompressedCorpus&) = delete;
+    CompressedCorpus& operator=(const CompressedCorpus&) = delete;
+
+    uint64_t length() const { return header.totalLength; }
+    size_t blockCount() const { return directory.size(); }
+    size_t maxPatternLength() const { return (size_t)header.overlap + 1; }
+
+    // All occurrences of pattern; patterns longer than maxPatternLength() are rejected.
+    CorpusSearchResult search(const std::string& pattern) const {
+        using namespace corpus_detail;
+        CorpusSearchResult result;
+        if (pattern.empty()) return result;
+        if (pattern.size() > maxPatternLength())
+            throw std::invalid_argument("pattern longer than the corpus block overlap allows");
+
+        for (const BlockInfo& info : directory) {
+            bool possible = pattern.size() <= info.length;
+            for (unsigned char c : pattern) possible = possible && info.histogram[c] > 0;
+            if (!possible) { result.blocksSkipped++; continue; }
+
+            BlockReader reader(file, info, header.segmentRows, result.bytesRead);
+            result.blocksRead++;
+
+            // Backward search over rows [sp, ep)
+            uint32_t C[256];
+            buildC(info.histogram, C);
+            uint64_t sp = 0, ep = reader.rowCount();
+            for (size_t i = pattern.size(); i-- > 0 && sp < ep;) {
+                unsigned char c = pattern[i];
+                sp = C[c] + reader.rank(c, sp);
+                ep = C[c] + reader.rank(c, ep);
+            }
+            if (sp >= ep) continue;
+
+            result.blocksDecoded++;
+            std::string text = decodeBlock(info, reader);
+            for (int pos : kmpSearch(text, pattern)) {
+                if ((uint32_t)pos < info.ownLength) result.positions.push_back(info.textStart + pos);
+            }
+        }
+        return result;
+    }
+
+    // Decodes every block back to the original text.
+    std::string decompress() const {
+        std::string text;
+        size_t bytesRead = 0;
+        for (const corpus_detail::BlockInfo& info : directory) {
+            corpus_detail::BlockReader reader(file, info, header.segmentRows, bytesRead);
+            std::string block = decodeBlock(info, reader);
+            text.append(block, 0, info.ownLength);
+        }
+        return text;
+    }
+};
+
+} // namespace stringworks
@@ -1,120 +1,102 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <unordered_set>
-#include <unordered_map> 
-#include <cmath>
+#include <cstdlib>     // For malloc/free in the allocation counter
+#include <new>
+#include <chrono>
+#include <random>
+#include <atomic>
 #include <algorithm>
 
-using namespace std;
+#include "TextSimilarity.h"
 
-class RabinKarpChecker {
-private:
-    long long d = 256;      // Base 
-    long long q = 1000000007; // A large prime modulus (restored from 13)
-    string A, B;
-
-public:
-    RabinKarpChecker(const string& docA, const string& docB) : A(docA), B(docB) {}
-
-    // The Check(K) subproblem
-    bool check(int K) {
-        if (K == 0)
-            return true;
-        // Check for bounds early
-        if (K > A.length() || K > B.length())
-            return false;
-
-        // 1. Hashing Document A
-        unordered_map<long long, vector<int>> hashesA;
-
-        long long h = 1; // d^(K-1) % q
-        for (int i = 0; i < K - 1; ++i) {
-            h = (h * d) % q;
-        }
-
-        long long currentHashA = 0;
-        for (int i = 0; i < K; ++i) {
-            currentHashA = (d * currentHashA + A[i]) % q;
-        }
-        
-        hashesA[currentHashA].push_back(0);
-
-
-        // Compute rolling hashes for the rest of A
-        for (int i = 0; i <= (int)A.length() - K - 1; ++i) {
-            currentHashA = (d * (currentHashA - A[i] * h) + A[i + K]) % q;
-            if (currentHashA < 0) currentHashA += q;
-
-            // Store the hash at index i+1
-            hashesA[currentHashA].push_back(i + 1);
-        }
-
-        // 2. Checking Document B
-        long long currentHashB = 0;
-        for (int i = 0; i < K; ++i) {
-            currentHashB = (d * currentHashB + B[i]) % q;
-        }
-        if (hashesA.count(currentHashB)) {
-            string subB = B.substr(0, K); // Get B's substring once
-            for (int indexA : hashesA[currentHashB]) { // Iterate all A's indices with this hash
-                if (A.substr(indexA, K) == subB) {
-                    return true; // Found a true match
-                }
-            }
-        }
-
-        // Check rolling hashes for the rest of B
-        for (int i = 0; i <= (int)B.length() - K - 1; ++i) {
-            currentHashB = (d * (currentHashB - B[i] * h) + B[i + K]) % q;
-            if (currentHashB < 0) currentHashB += q;
-
-            if (hashesA.count(currentHashB)) {
-                string subB = B.substr(i + 1, K); // Get B's substring
-                for (int indexA : hashesA[currentHashB]) { // Iterate all A's indices
-                    if (A.substr(indexA, K) == subB) {
-                        return true; // Found a true match
-                    }
-                }
-            }
-        }
-
-        // 4. No match
-        return false;
+using namespace std;
+using namespace stringworks;
+
+// Reads one document per line from stdin and prints the near-duplicate pairs.
+int runCorpusMode(const CorpusOptions& options) {
+    vector<string> docs;
+    string line;
+    while (getline(cin, line)) docs.push_back(line);
+
+    vector<NearDuplicatePair> pairs = findNearDuplicates(docs, options);
+
+    cout << "Documents: " << docs.size() << endl;
+    cout << "Near-duplicate pairs: " << pairs.size() << endl;
+    for (const NearDuplicatePair& p : pairs) {
+        cout << "  doc " << p.docA << " ~ doc " << p.docB
+             << "  resemblance ~" << p.estimatedResemblance
+             << "  longest common substring " << p.longestMatch << endl;
     }
-};
+    return 0;
+}
 
+// --- Allocation Benchmark (run with --bench) ---
 
-int findLongestMatch(const string& docA, const string& docB) {
-    int n = docA.length();
-    int m = docB.length();
-    int low = 0;
-    int high = min(n, m);
-    int maxLen = 0;
+// Counts every global operator new so the benchmark can show how many heap
+// allocations the checker performs per probe.
+static atomic<size_t> allocationCount{ 0 };
 
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// Random documents over a small alphabet that share one planted substring,
+// so the binary search visits both "Found" and "Not Found" lengths.
+int runAllocationBenchmark(int docLength) {
+    mt19937 rng(42);
+    uniform_int_distribution<int> letter('a', 'h');
+    auto randomDoc = [&](int len) {
+        string s(len, ' ');
+        for (char& c : s) c = (char)letter(rng);
+        return s;
+    };
+    string docA = randomDoc(docLength);
+    string docB = randomDoc(docLength);
+    string shared = randomDoc(max(1, docLength / 100));
+    docA.replace(docLength / 3, shared.length(), shared);
+    docB.replace(docLength / 2, shared.length(), shared);
+
+    size_t before = allocationCount;
     RabinKarpChecker checker(docA, docB);
+    size_t constructionAllocs = allocationCount - before;
 
-    cout << "Starting D&C Binary Search on length..." << endl;
-
+    before = allocationCount;
+    auto start = chrono::steady_clock::now();
+    int low = 0, high = docLength, maxLen = 0, probes = 0;
     while (low <= high) {
         int K = low + (high - low) / 2;
-        cout << "  Checking K = " << K << "...";
-
-        if (checker.check(K)) {
-            cout << "  Result: Found." << endl;
-            maxLen = K;       // This is a possible answer
-            low = K + 1;      // Try to find a longer one 
-        }
-        else {
-            cout << "  Result: Not Found." << endl;
-            high = K - 1;     // This length is too long
-        }
+        ++probes;
+        if (checker.check(K)) { maxLen = K; low = K + 1; }
+        else high = K - 1;
     }
-
-    return maxLen;
+    auto elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    size_t probeAllocs = allocationCount - before;
+
+    cout << "Document length:         " << docLength << endl;
+    cout << "Longest common substring: " << maxLen << endl;
+    cout << "Probes (check(K) calls):  " << probes << endl;
+    cout << "Allocations in ctor:      " << constructionAllocs << endl;
+    cout << "Allocations in probes:    " << probeAllocs << endl;
+    cout << "Total probe time (ms):    " << elapsed << endl;
+    return 0;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        return runAllocationBenchmark(argc > 2 ? atoi(argv[2]) : 200000);
+    }
+    if (argc > 1 && string(argv[1]) == "--corpus") {
+        CorpusOptions options;
+        if (argc > 2) options.shingleLength = max(1, atoi(argv[2]));
+        return runCorpusMode(options);
+    }
+
     string docA, docB;
 
     cout << "Enter Document A: ";
@@ -127,10 +109,39 @@ int main() {
     cout << "Document B: " << docB << endl;
 
     // --- Algorithm Execution ---
-    int resultLength = findLongestMatch(docA, docB);
+    SearchStats stats;
+    int resultLength = 0;
+    {
+        StatsScope scope(stats, "longest-match");
+        resultLength = findLongestMatch(docA, docB);
+    }
+    if (statsEnabled) cout << "Search stats: " << stats.toJson() << endl;
 
     cout << "\nAlgorithm complete." << endl;
     cout << "Maximum Common Substring Length: " << resultLength << endl;
 
+    // --- Detailed Comparison ---
+    int minLength = 0;
+    cout << "\nEnter minimum match length to report (0 to skip): ";
+    if (!(cin >> minLength) || minLength <= 0)
+        return 0;
+
+    DocumentIndex indexA(docA, minLength);
+    SearchStats compareStats;
+    SimilarityReport report;
+    {
+        StatsScope scope(compareStats, "document-index");
+        report = indexA.compare(docB);
+    }
+    if (statsEnabled) cout << "Search stats: " << compareStats.toJson() << endl;
+
+    cout << "\nMaximal common substrings (length >= " << minLength << "): " << report.matches.size() << endl;
+    for (const CommonSubstring& match : report.matches) {
+        cout << "  A[" << match.posA << "] B[" << match.posB << "] length " << match.length
+             << ": \"" << docA.substr(match.posA, match.length) << "\"" << endl;
+    }
+    cout << "Containment of B in A: " << report.containment << endl;
+    cout << "Resemblance:           " << report.resemblance << endl;
+
     return 0;
 }
\ No newline at end of file
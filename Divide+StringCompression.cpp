@@ -1,130 +1,155 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <algorithm>
+#include <fstream>
+#include <cstdlib>
+#include <stdexcept>
 
-using namespace std;
-
-// --- Helper: Compare two suffixes explicitly ---
-// Returns true if suffix at index i is lexicographically smaller than suffix at index j
-bool isSmaller(const string& text, int i, int j) {
-    int n = text.length();
-    while (i < n && j < n) {
-        if (text[i] < text[j]) return true;
-        if (text[i] > text[j]) return false;
-        i++;
-        j++;
-    }
-    // If one runs out, the shorter one is "smaller"
-    return i == n && j < n;
-}
+#include "SuffixArrayDC.h"
+#include "SuffixArrayQuery.h"
+#include "ExternalSuffixArray.h"
+#include "CompressedCorpus.h"
+#include "LZFactorization.h"
 
-// --- PART 1: DIVIDE AND CONQUER (Merge Sort) ---
+using namespace std;
+using namespace stringworks;
 
-// The "Merge" step of Divide and Conquer
-void merge(const string& text, vector<int>& suffixes, int left, int mid, int right) {
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
+// Disk-backed mode: string_compression --external <input> <outputPrefix> [--ram-mb N] [--temp-dir DIR]
+int runExternalMode(int argc, char* argv[]) {
+    if (argc < 4) {
+        cout << "Usage: " << argv[0] << " --external <input> <outputPrefix> [--ram-mb N] [--temp-dir DIR]" << endl;
+        return 1;
+    }
+    ExternalBuildOptions options;
+    for (int i = 4; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        if (arg == "--ram-mb") options.ramBudgetBytes = (size_t)max(1, atoi(argv[i + 1])) << 20;
+        else if (arg == "--temp-dir") options.tempDir = argv[i + 1];
+    }
 
-    // Create temp arrays
-    vector<int> L(n1), R(n2);
+    try {
+        ExternalBuildResult result = buildSuffixArrayExternal(argv[2], argv[3], options);
+        cout << "Suffixes:        " << result.length << endl;
+        cout << "Doubling rounds: " << result.rounds << endl;
+        cout << "Sorted runs:     " << result.runs << endl;
+        cout << "Merge passes:    " << result.mergePasses << endl;
+        cout << "Wrote " << argv[3] << ".sa, " << argv[3] << ".lcp and " << argv[3] << ".bwt" << endl;
+    }
+    catch (const exception& e) {
+        cout << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
 
-    for (int i = 0; i < n1; i++)
-        L[i] = suffixes[left + i];
-    for (int j = 0; j < n2; j++)
-        R[j] = suffixes[mid + 1 + j];
+// Compressed corpus modes:
+//   string_compression --pack <input> <archive> [--block-kb N]
+//   string_compression --grep <archive> <pattern>
+//   string_compression --unpack <archive> <output>
+int runCorpusMode(int argc, char* argv[]) {
+    string mode = argv[1];
+    if (argc < 4) {
+        cout << "Usage: " << argv[0] << " --pack <input> <archive> [--block-kb N]" << endl;
+        cout << "       " << argv[0] << " --grep <archive> <pattern>" << endl;
+        cout << "       " << argv[0] << " --unpack <archive> <output>" << endl;
+        return 1;
+    }
 
-    // Merge the temp arrays back into suffixes[left..right]
-    int i = 0, j = 0, k = left;
-    while (i < n1 && j < n2) {
-        // CRITICAL: String comparison happens here
-        if (isSmaller(text, L[i], R[j])) {
-            suffixes[k] = L[i];
-            i++;
+    try {
+        if (mode == "--pack") {
+            CorpusBuildOptions options;
+            if (argc > 5 && string(argv[4]) == "--block-kb") options.blockSize = (uint32_t)max(1, atoi(argv[5])) << 10;
+            ifstream in(argv[2], ios::binary);
+            if (!in) throw runtime_error(string("cannot open ") + argv[2]);
+            writeCompressedCorpus(in, argv[3], options);
+            CompressedCorpus corpus(argv[3]);
+            cout << "Packed " << corpus.length() << " bytes into " << corpus.blockCount() << " blocks." << endl;
+        }
+        else if (mode == "--grep") {
+            CompressedCorpus corpus(argv[2]);
+            CorpusSearchResult result = corpus.search(argv[3]);
+            cout << "Occurrences: " << result.positions.size() << endl;
+            for (int64_t pos : result.positions) cout << pos << " ";
+            if (!result.positions.empty()) cout << endl;
+            cout << "Blocks skipped by histogram: " << result.blocksSkipped << endl;
+            cout << "Blocks searched compressed:  " << result.blocksRead << endl;
+            cout << "Blocks decoded:              " << result.blocksDecoded << " of " << corpus.blockCount() << endl;
+            cout << "Compressed bytes read:       " << result.bytesRead << endl;
         }
         else {
-            suffixes[k] = R[j];
-            j++;
+            CompressedCorpus corpus(argv[2]);
+            ofstream out(argv[3], ios::binary);
+            string text = corpus.decompress();
+            out.write(text.data(), text.size());
+            if (!out) throw runtime_error(string("cannot write ") + argv[3]);
         }
-        k++;
     }
-
-    // Copy remaining elements
-    while (i < n1) {
-        suffixes[k] = L[i];
-        i++;
-        k++;
-    }
-    while (j < n2) {
-        suffixes[k] = R[j];
-        j++;
-        k++;
+    catch (const exception& e) {
+        cout << "Error: " << e.what() << endl;
+        return 1;
     }
+    return 0;
 }
 
-// The Recursive "Divide" step
-void mergeSortSuffixes(const string& text, vector<int>& suffixes, int left, int right) {
-    if (left < right) {
-        int mid = left + (right - left) / 2;
-
-        // DIVIDE: Recursively sort first and second halves
-        mergeSortSuffixes(text, suffixes, left, mid);
-        mergeSortSuffixes(text, suffixes, mid + 1, right);
+void printRepetitiveness(const RepetitivenessStats& stats) {
+    cout << "Length (n):            " << stats.length << endl;
+    cout << "LZ77 factors (z):      " << stats.factors << " (" << stats.literals << " literals)" << endl;
+    cout << "Mean factor length:    " << stats.meanFactorLength << endl;
+    cout << "BWT runs (r):          " << stats.bwtRuns << endl;
+    cout << "LZ77 encoded bytes:    " << stats.lzBytes << endl;
+    cout << "BWT encoded bytes:     " << stats.bwtBytes << endl;
+    cout << "Suggested compression: " << (stats.preferBWT ? "BWT" : "LZ77") << endl;
+}
 
-        // COMBINE: Merge the sorted halves
-        merge(text, suffixes, left, mid, right);
+// LZ77 modes:
+//   string_compression --lz-compress <input> <output>
+//   string_compression --lz-decompress <input> <output>
+//   string_compression --lz-stats <input>
+int runLZMode(int argc, char* argv[]) {
+    string mode = argv[1];
+    if (argc < (mode == "--lz-stats" ? 3 : 4)) {
+        cout << "Usage: " << argv[0] << " --lz-compress <input> <output>" << endl;
+        cout << "       " << argv[0] << " --lz-decompress <input> <output>" << endl;
+        cout << "       " << argv[0] << " --lz-stats <input>" << endl;
+        return 1;
     }
-}
 
-// Wrapper function to start the D&C process
-vector<int> buildSuffixArrayDC(const string& text) {
-    int n = text.length();
-    vector<int> suffixes(n);
-    // Initialize with indices 0 to n-1
-    for (int i = 0; i < n; i++) suffixes[i] = i;
+    try {
+        ifstream in(argv[2], ios::binary);
+        if (!in) throw runtime_error(string("cannot open ") + argv[2]);
+        string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
 
-    // Start Divide and Conquer
-    mergeSortSuffixes(text, suffixes, 0, n - 1);
-    return suffixes;
-}
-
-// --- PART 2: FIND REPETITIONS (LCP Calculation) ---
+        if (mode == "--lz-stats") {
+            vector<int> suffixArr = buildSuffixArrayDoubling(data);
+            vector<int> lcpArr = buildLCPArray(data, suffixArr);
+            printRepetitiveness(analyzeRepetitiveness(data, suffixArr, lcpArr));
+            return 0;
+        }
 
-// Calculates Longest Common Prefix between two specific suffixes
-int computeLCP(const string& text, int i, int j) {
-    int n = text.length();
-    int len = 0;
-    while (i + len < n && j + len < n && text[i + len] == text[j + len]) {
-        len++;
+        string result = mode == "--lz-compress" ? lz77Compress(data) : lz77Decompress(data);
+        ofstream out(argv[3], ios::binary);
+        out.write(result.data(), result.size());
+        if (!out) throw runtime_error(string("cannot write ") + argv[3]);
+        cout << data.size() << " -> " << result.size() << " bytes" << endl;
     }
-    return len;
-}
-
-// Builds the LCP array based on the sorted Suffix Array
-vector<int> buildLCPArray(const string& text, const vector<int>& suffixArr) {
-    int n = text.length();
-    vector<int> lcp(n, 0);
-
-    // Compare adjacent suffixes in the sorted list
-    for (int i = 1; i < n; i++) {
-        lcp[i] = computeLCP(text, suffixArr[i - 1], suffixArr[i]);
+    catch (const exception& e) {
+        cout << "Error: " << e.what() << endl;
+        return 1;
     }
-    return lcp;
+    return 0;
 }
 
-// --- PART 3: COMPRESSION OUTPUTS ---
-
-string buildBWT(const string& text, const vector<int>& suffixArr) {
-    int n = text.length();
-    string bwt = "";
-    for (int i = 0; i < n; i++) {
-        if (suffixArr[i] == 0) bwt += text[n - 1];
-        else bwt += text[suffixArr[i] - 1];
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]).rfind("--lz-", 0) == 0) {
+        return runLZMode(argc, argv);
+    }
+    if (argc > 1 && string(argv[1]) == "--external") {
+        return runExternalMode(argc, argv);
+    }
+    if (argc > 1 && (string(argv[1]) == "--pack" || string(argv[1]) == "--grep" || string(argv[1]) == "--unpack")) {
+        return runCorpusMode(argc, argv);
     }
-    return bwt;
-}
 
-int main() {
     // 1. INPUT
     string text;
     cout << "--- Divide & Conquer String Processing ---" << endl;
@@ -141,7 +166,13 @@ int main() {
     cout << "Processing: " << text << endl;
 
     // 2. Build Suffix Array using Divide & Conquer
-    vector<int> suffixArr = buildSuffixArrayDC(text);
+    SearchStats buildStats;
+    vector<int> suffixArr;
+    {
+        StatsScope scope(buildStats, "suffix-array");
+        suffixArr = buildSuffixArrayDC(text);
+    }
+    if (statsEnabled) cout << "Build stats: " << buildStats.toJson() << endl;
 
     // 3. Build LCP Array
     vector<int> lcpArr = buildLCPArray(text, suffixArr);
@@ -178,5 +209,40 @@ int main() {
     string bwt = buildBWT(text, suffixArr);
     cout << "Burrows-Wheeler Transform: " << bwt << endl;
 
+    cout << "\n--- Task 4: LZ77 Factorization ---" << endl;
+    vector<LZFactor> factors = lz77Factorize(text, suffixArr, lcpArr);
+    cout << "Factors:";
+    for (size_t i = 0; i < factors.size() && i < 30; ++i) {
+        if (factors[i].source < 0) cout << " '" << factors[i].literal << "'";
+        else cout << " (" << factors[i].source << "," << factors[i].length << ")";
+    }
+    cout << (factors.size() > 30 ? " ..." : "") << endl;
+    printRepetitiveness(analyzeRepetitiveness(text, suffixArr, lcpArr));
+
+    cout << "\n--- Task 5: Pattern Lookups ---" << endl;
+    cout << "Enter patterns to look up (one per line, empty line to finish):" << endl;
+    vector<string> queries;
+    string query;
+    while (getline(cin, query) && !query.empty()) queries.push_back(query);
+
+    if (!queries.empty()) {
+        SuffixArrayIndex index(text, suffixArr, lcpArr);
+        SearchStats stats;
+        vector<PatternMatches> results;
+        {
+            StatsScope scope(stats, "sa-query");
+            results = index.queryBatch(queries, true);
+        }
+        if (statsEnabled) cout << "Search stats: " << stats.toJson() << endl;
+        for (size_t i = 0; i < queries.size(); ++i) {
+            cout << "\"" << queries[i] << "\" occurs " << results[i].count << " time(s)";
+            if (results[i].count > 0) {
+                cout << " at:";
+                for (int pos : results[i].positions) cout << " " << pos;
+            }
+            cout << endl;
+        }
+    }
+
     return 0;
 }
\ No newline at end of file
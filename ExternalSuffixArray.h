@@ -0,0 +1,477 @@
+#pragma once
+
+// Disk-backed suffix array / LCP / BWT construction for inputs larger than RAM.
+//
+// Construction is external prefix doubling: every pass works on fixed-size
+// records that are streamed through sequential scans and an external merge
+// sort (runs sorted in RAM, spilled to temp files, k-way merged), so no
+// suffixes are ever compared character by character.
+//   1. The inverse suffix array (ISA, the rank of each suffix in text order)
+//      starts as the first character of each suffix.
+//   2. Each round scans the ISA twice in step to form (rank[i], rank[i + h], i)
+//      tuples, sorts them, names each group of equal pairs by its first SA
+//      position, and sorts the names back into text order. The ranks then
+//      cover 2h characters; once every rank is distinct, the last sorted
+//      order is the SA.
+//   3. The BWT is (ISA[i], text[i - 1]) sorted by rank.
+//   4. The LCP comes from a Kasai-style pass over the permuted LCP (PLCP):
+//      Phi[i] (the suffix before i in SA order) is sorted into text order,
+//      PLCP[i] >= PLCP[i - 1] - 1 bounds the characters compared to 2n in
+//      total, and (ISA[i], PLCP[i]) is sorted back into SA order. This is the
+//      one phase that is not purely sequential: the text is scanned forward at
+//      i + PLCP[i], but read at a random offset Phi[i] + PLCP[i] once per
+//      suffix, so when the text does not fit in the page cache it costs about
+//      one random page read per suffix.
+//
+// Outputs match the in-memory path (buildSuffixArrayDC, buildLCPArray,
+// buildBWT) on the same text, including the auto-appended '$' sentinel:
+//   <prefix>.sa   int64 suffix indices, native byte order
+//   <prefix>.lcp  int64 LCP values, native byte order
+//   <prefix>.bwt  one byte per suffix
+// I/O failures are reported with std::runtime_error.
+
+#include <string>
+#include <vector>
+#include <queue>
+#include <utility>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define STRINGWORKS_HAVE_MMAP 1
+#endif
+
+namespace stringworks {
+
+struct ExternalBuildOptions {
+    size_t ramBudgetBytes = size_t(256) << 20; // Sort runs plus merge buffers
+    size_t ioBufferBytes = size_t(4) << 20;    // Per-stream buffer, shrunk to fit the budget
+    size_t maxFanIn = 64;                      // Runs merged per pass
+    std::string tempDir = ".";
+};
+
+struct ExternalBuildResult {
+    int64_t length = 0;   // Text length including the sentinel
+    int rounds = 0;       // Prefix-doubling rounds
+    size_t runs = 0;      // Sorted runs spilled to disk, over every sort
+    int mergePasses = 0;  // Merge passes, over every sort
+};
+
+// Read-only view of the input file plus the virtual '$' sentinel.
+class MappedText {
+private:
+    const char* data = nullptr;
+    int64_t fileLength = 0;
+    int64_t n = 0;
+    char sentinel = '$';
+#ifdef STRINGWORKS_HAVE_MMAP
+    void* mapping = nullptr;
+#else
+    std::string buffer;
+#endif
+
+public:
+    explicit MappedText(const std::string& path) {
+#ifdef STRINGWORKS_HAVE_MMAP
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("cannot open " + path);
+        struct stat st;
+        if (fstat(fd, &st) != 0) { close(fd); throw std::runtime_error("cannot stat " + path); }
+        fileLength = st.st_size;
+        if (fileLength > 0) {
+            mapping = mmap(nullptr, fileLength, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) { close(fd); throw std::runtime_error("cannot map " + path); }
+            data = static_cast<const char*>(mapping);
+#ifdef MADV_SEQUENTIAL
+            madvise(mapping, fileLength, MADV_SEQUENTIAL); // Steps 1-3 only scan the text
+#endif
+        }
+        close(fd);
+#else
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("cannot open " + path);
+        buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        data = buffer.data();
+        fileLength = buffer.size();
+#endif
+        // Same rule as the interactive driver: append '$' unless already there
+        n = (fileLength > 0 && data[fileLength - 1] == '$') ? fileLength : fileLength + 1;
+    }
+
+    ~MappedText() {
+#ifdef STRINGWORKS_HAVE_MMAP
+        if (mapping) munmap(mapping, fileLength);
+#endif
+    }
+    MappedText(const MappedText&) = delete;
+    MappedText& operator=(const MappedText&) = delete;
+
+    int64_t length() const { return n; }
+    char at(int64_t i) const { return i < fileLength ? data[i] : sentinel; }
+
+    // Drops the sequential hint before random reads, so the kernel keeps the
+    // pages the reads land on instead of freeing them behind the scan.
+    void adviseRandomReads() {
+#if defined(STRINGWORKS_HAVE_MMAP) && defined(MADV_NORMAL)
+        if (mapping) madvise(mapping, fileLength, MADV_NORMAL);
+#endif
+    }
+};
+
+// Sequential byte stream with a large user-space buffer.
+class RunWriter {
+private:
+    FILE* file;
+    std::string path;
+    std::vector<char> buffer;
+    size_t used = 0;
+
+    void flush() {
+        if (used > 0 && fwrite(buffer.data(), 1, used, file) != used)
+            throw std::runtime_error("write failed: " + path);
+        used = 0;
+    }
+
+public:
+    RunWriter(const std::string& path, size_t bufferBytes) : path(path), buffer(std::max<size_t>(bufferBytes, 4096)) {
+        file = fopen(path.c_str(), "wb");
+        if (!file) throw std::runtime_error("cannot create " + path);
+    }
+    ~RunWriter() { if (file) fclose(file); }
+    RunWriter(const RunWriter&) = delete;
+    RunWriter& operator=(const RunWriter&) = delete;
+
+    void write(const void* bytes, size_t size) {
+        if (used + size > buffer.size()) flush();
+        if (size > buffer.size()) { // Large blocks go straight to the file
+            if (fwrite(bytes, 1, size, file) != size) throw std::runtime_error("write failed: " + path);
+            return;
+        }
+        memcpy(buffer.data() + used, bytes, size);
+        used += size;
+    }
+    template <typename T>
+    void put(const T& value) { write(&value, sizeof(value)); }
+
+    void close() {
+        flush();
+        if (fclose(file) != 0) { file = nullptr; throw std::runtime_error("close failed: " + path); }
+        file = nullptr;
+    }
+};
+
+// Sequential stream of fixed-size records, optionally starting `skip` records in.
+template <typename T>
+class RunReader {
+private:
+    FILE* file;
+    std::string path;
+    std::vector<T> buffer;
+    size_t pos = 0, count = 0;
+
+public:
+    RunReader(const std::string& path, size_t bufferBytes, int64_t skip = 0)
+        : path(path), buffer(std::max<size_t>(bufferBytes / sizeof(T), 512)) {
+        file = fopen(path.c_str(), "rb");
+        if (!file) throw std::runtime_error("cannot open " + path);
+#ifdef STRINGWORKS_HAVE_MMAP
+        bool seekFailed = skip > 0 && fseeko(file, (off_t)(skip * (int64_t)sizeof(T)), SEEK_SET) != 0;
+#else
+        bool seekFailed = skip > 0 && fseek(file, (long)(skip * (int64_t)sizeof(T)), SEEK_SET) != 0;
+#endif
+        if (seekFailed) {
+            fclose(file);
+            throw std::runtime_error("seek failed: " + path);
+        }
+    }
+    ~RunReader() { if (file) fclose(file); }
+    RunReader(const RunReader&) = delete;
+    RunReader& operator=(const RunReader&) = delete;
+
+    bool next(T& value) {
+        if (pos == count) {
+            count = fread(buffer.data(), sizeof(T), buffer.size(), file);
+            pos = 0;
+            if (count == 0) {
+                if (ferror(file)) throw std::runtime_error("read failed: " + path);
+                return false;
+            }
+        }
+        value = buffer[pos++];
+        return true;
+    }
+
+    T nextOrThrow() {
+        T value;
+        if (!next(value)) throw std::runtime_error("unexpected end of " + path);
+        return value;
+    }
+};
+
+namespace external_detail {
+
+// (rank of the first h characters, rank of the next h, suffix index)
+struct RankTuple {
+    int64_t rank;
+    int64_t next; // -1 when the suffix is shorter than h + 1
+    int64_t index;
+};
+
+struct ByRankPair {
+    bool operator()(const RankTuple& a, const RankTuple& b) const {
+        return a.rank != b.rank ? a.rank < b.rank : a.next < b.next;
+    }
+};
+
+struct KeyValue {
+    int64_t key;
+    int64_t value;
+};
+
+struct ByKey {
+    bool operator()(const KeyValue& a, const KeyValue& b) const { return a.key < b.key; }
+};
+
+// Budget and temp-file bookkeeping shared by every sort of one build.
+struct SortContext {
+    const ExternalBuildOptions& options;
+    ExternalBuildResult& result;
+    size_t fanIn;
+    size_t ioBuffer;               // Per stream
+    size_t runBytes;               // RAM for the records of one run
+    std::vector<std::string> created; // Every temp file, removed on success or failure
+    int counter = 0;
+
+    SortContext(const ExternalBuildOptions& options, ExternalBuildResult& result)
+        : options(options), result(result) {
+        fanIn = std::max<size_t>(options.maxFanIn, 2);
+        // Half of the budget for merge buffers, half for the run being formed
+        ioBuffer = std::min(options.ioBufferBytes, std::max<size_t>(options.ramBudgetBytes / 2 / (fanIn + 4), 4096));
+        runBytes = std::max<size_t>(options.ramBudgetBytes / 2, 64 << 10);
+    }
+
+    std::string tempPath(const char* kind) {
+#ifdef STRINGWORKS_HAVE_MMAP
+        long pid = (long)getpid();
+#else
+        long pid = 0;
+#endif
+        created.push_back(options.tempDir + "/sa_" + kind + "_" + std::to_string(pid) + "_" + std::to_string(counter++) + ".tmp");
+        return created.back();
+    }
+
+    void removeAll() {
+        for (const std::string& path : created) std::remove(path.c_str());
+        created.clear();
+    }
+};
+
+// External merge sort of fixed-size records. push() every record, then
+// finish(emit) streams them back in order. Input that fits one run never
+// touches the disk.
+template <typename T, typename Less>
+class ExternalSorter {
+private:
+    SortContext& ctx;
+    Less less;
+    std::vector<T> buffer;
+    size_t capacity;
+    std::vector<std::string> runs;
+
+    void spill() {
+        if (buffer.empty()) return;
+        std::sort(buffer.begin(), buffer.end(), less);
+        runs.push_back(ctx.tempPath("run"));
+        RunWriter writer(runs.back(), ctx.ioBuffer);
+        writer.write(buffer.data(), buffer.size() * sizeof(T));
+        writer.close();
+        buffer.clear();
+        ctx.result.runs++;
+    }
+
+    template <typename Emit>
+    void merge(const std::vector<std::string>& paths, Emit&& emit) {
+        std::vector<std::unique_ptr<RunReader<T>>> readers;
+        for (const std::string& path : paths) readers.push_back(std::make_unique<RunReader<T>>(path, ctx.ioBuffer));
+
+        // Min-heap on record order; the top is the smallest remaining record
+        using Head = std::pair<T, size_t>; // (record, run)
+        auto greater = [&](const Head& a, const Head& b) { return less(b.first, a.first); };
+        std::priority_queue<Head, std::vector<Head>, decltype(greater)> heap(greater);
+
+        for (size_t r = 0; r < readers.size(); ++r) {
+            T record;
+            if (readers[r]->next(record)) heap.push({ record, r });
+        }
+        while (!heap.empty()) {
+            Head top = heap.top();
+            heap.pop();
+            emit(top.first);
+            T record;
+            if (readers[top.second]->next(record)) heap.push({ record, top.second });
+        }
+    }
+
+public:
+    explicit ExternalSorter(SortContext& ctx, Less less = Less())
+        : ctx(ctx), less(less), capacity(std::max<size_t>(ctx.runBytes / sizeof(T), 1024)) {}
+
+    void push(const T& record) {
+        if (buffer.empty()) buffer.reserve(capacity);
+        buffer.push_back(record);
+        if (buffer.size() == capacity) spill();
+    }
+
+    template <typename Emit>
+    void finish(Emit&& emit) {
+        if (runs.empty()) {
+            std::sort(buffer.begin(), buffer.end(), less);
+            for (const T& record : buffer) emit(record);
+            buffer = std::vector<T>();
+            return;
+        }
+        spill();
+        buffer = std::vector<T>(); // Release the run memory before merging
+
+        // Intermediate passes until one merge can take every run
+        while (runs.size() > ctx.fanIn) {
+            std::vector<std::string> merged;
+            for (size_t first = 0; first < runs.size(); first += ctx.fanIn) {
+                std::vector<std::string> group(runs.begin() + first, runs.begin() + std::min(runs.size(), first + ctx.fanIn));
+                merged.push_back(ctx.tempPath("run"));
+                RunWriter writer(merged.back(), ctx.ioBuffer);
+                merge(group, [&](const T& record) { writer.put(record); });
+                writer.close();
+                for (const std::string& path : group) std::remove(path.c_str());
+            }
+            runs = merged;
+            ctx.result.mergePasses++;
+        }
+        merge(runs, emit);
+        ctx.result.mergePasses++;
+        for (const std::string& path : runs) std::remove(path.c_str());
+        runs.clear();
+    }
+};
+
+} // namespace external_detail
+
+/**
+ * Builds SA, LCP and BWT of the file at inputPath into outputPrefix.{sa,lcp,bwt}
+ * while keeping at most about ramBudgetBytes of records in memory.
+ */
+inline ExternalBuildResult buildSuffixArrayExternal(const std::string& inputPath, const std::string& outputPrefix,
+    const ExternalBuildOptions& options = ExternalBuildOptions()) {
+    using namespace external_detail;
+    MappedText text(inputPath);
+    ExternalBuildResult result;
+    result.length = text.length();
+    int64_t n = text.length();
+    SortContext ctx(options, result);
+
+    try {
+        // 1. Initial ranks: the first character, in the signed char order of isSmaller
+        std::string isaPath = ctx.tempPath("isa");
+        {
+            RunWriter isaOut(isaPath, ctx.ioBuffer);
+            for (int64_t i = 0; i < n; ++i) isaOut.put((int64_t)((signed char)text.at(i) + 128));
+            isaOut.close();
+        }
+
+        // 2. Doubling rounds; each writes its sorted order as the candidate SA
+        for (int64_t h = 1;; h *= 2) {
+            result.rounds++;
+            ExternalSorter<RankTuple, ByRankPair> byRank(ctx);
+            {
+                RunReader<int64_t> current(isaPath, ctx.ioBuffer);
+                RunReader<int64_t> ahead(isaPath, ctx.ioBuffer, std::min(h, n));
+                for (int64_t i = 0; i < n; ++i) {
+                    int64_t rank = current.nextOrThrow();
+                    byRank.push({ rank, i + h < n ? ahead.nextOrThrow() : -1, i });
+                }
+            }
+
+            // Name each suffix by the first SA position of its (rank, next) group
+            ExternalSorter<KeyValue, ByKey> byIndex(ctx);
+            bool distinct = true;
+            int64_t position = 0, groupStart = 0;
+            RankTuple previous = { -1, -1, -1 };
+            RunWriter saOut(outputPrefix + ".sa", ctx.ioBuffer);
+            byRank.finish([&](const RankTuple& t) {
+                if (position == 0 || t.rank != previous.rank || t.next != previous.next) groupStart = position;
+                else distinct = false;
+                byIndex.push({ t.index, groupStart });
+                saOut.put(t.index);
+                previous = t;
+                position++;
+            });
+            saOut.close();
+
+            std::remove(isaPath.c_str());
+            isaPath = ctx.tempPath("isa");
+            RunWriter isaOut(isaPath, ctx.ioBuffer);
+            byIndex.finish([&](const KeyValue& kv) { isaOut.put(kv.value); });
+            isaOut.close();
+            if (distinct || h >= n) break;
+        }
+
+        // 3. BWT: the character before each suffix, moved to its rank
+        {
+            ExternalSorter<KeyValue, ByKey> byRank(ctx);
+            RunReader<int64_t> isa(isaPath, ctx.ioBuffer);
+            for (int64_t i = 0; i < n; ++i)
+                byRank.push({ isa.nextOrThrow(), (int64_t)(unsigned char)text.at(i == 0 ? n - 1 : i - 1) });
+            RunWriter bwtOut(outputPrefix + ".bwt", ctx.ioBuffer);
+            byRank.finish([&](const KeyValue& kv) { bwtOut.put((char)kv.value); });
+            bwtOut.close();
+        }
+
+        // 4. LCP: Phi into text order, PLCP by a Kasai-style scan, back into SA order.
+        //    The scan reads the text at Phi[i] as well as at i (see the top of the file).
+        {
+            text.adviseRandomReads();
+            ExternalSorter<KeyValue, ByKey> phi(ctx);
+            {
+                RunReader<int64_t> sa(outputPrefix + ".sa", ctx.ioBuffer);
+                int64_t previous = -1;
+                for (int64_t k = 0; k < n; ++k) {
+                    int64_t suffix = sa.nextOrThrow();
+                    phi.push({ suffix, previous });
+                    previous = suffix;
+                }
+            }
+
+            ExternalSorter<KeyValue, ByKey> byRank(ctx);
+            RunReader<int64_t> isa(isaPath, ctx.ioBuffer);
+            int64_t len = 0;
+            phi.finish([&](const KeyValue& kv) {
+                int64_t i = kv.key, before = kv.value;
+                if (before < 0) len = 0;
+                else while (i + len < n && before + len < n && text.at(i + len) == text.at(before + len)) len++;
+                byRank.push({ isa.nextOrThrow(), before < 0 ? 0 : len });
+                if (len > 0) len--;
+            });
+
+            RunWriter lcpOut(outputPrefix + ".lcp", ctx.ioBuffer);
+            byRank.finish([&](const KeyValue& kv) { lcpOut.put(kv.value); });
+            lcpOut.close();
+        }
+    }
+    catch (...) {
+        ctx.removeAll();
+        throw;
+    }
+    ctx.removeAll();
+    return result;
+}
+
+} // namespace stringworks
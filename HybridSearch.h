@@ -0,0 +1,315 @@
+#pragma once
+
+// Single-pattern engines (Naive, KMP, Rabin-Karp), the adaptive selector that
+// switches between them, and same-length multi-pattern Rabin-Karp.
+// All engines are quiet unless a log stream is passed in.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_set> // For Task 2
+#include <cmath>         // For pow()
+
+#include "SearchStats.h"
+
+namespace stringworks {
+
+// --- 1. Naive Algorithm ---
+inline std::vector<int> naiveSearch(const std::string& text, const std::string& pattern) {
+    SW_STATS_BEGIN();
+    std::vector<int> matches;
+    int n = text.length();
+    int m = pattern.length();
+    SW_STAT_ADD(bytesScanned, n);
+
+    for (int i = 0; i <= n - m; i++) {
+        int j;
+        for (j = 0; j < m; ++j) {
+            if (text[i + j] != pattern[j]) {
+                break;
+            }
+        }
+        SW_STAT_ADD(charComparisons, j < m ? j + 1 : m);
+        if (j == m) {
+            matches.push_back(i);
+        }
+    }
+    return matches;
+}
+
+// --- 2. KMP Algorithm ---
+inline std::vector<int> computeLPS(const std::string& pattern) {
+    int m = pattern.length();
+    std::vector<int> lps(m, 0);
+    int length = 0; // Length of the previous longest prefix suffix
+    int i = 1;
+
+    while (i < m) {
+        if (pattern[i] == pattern[length]) {
+            length++;
+            lps[i] = length;
+            i++;
+        }
+        else {
+            if (length != 0) {
+                length = lps[length - 1];
+            }
+            else {
+                lps[i] = 0;
+                i++;
+            }
+        }
+    }
+    return lps;
+}
+
+inline std::vector<int> kmpSearch(const std::string& text, const std::string& pattern, int startIndex = 0) {
+    SW_STATS_BEGIN();
+    std::vector<int> matches;
+    int n = text.length();
+    int m = pattern.length();
+
+    if (m == 0) return matches;
+    SW_STAT_ADD(bytesScanned, std::max(0, n - startIndex));
+
+    std::vector<int> lps = computeLPS(pattern);
+    int i = startIndex; // text index
+    int j = 0;          // pattern index
+
+    while (i < n) {
+        SW_STAT_ADD(charComparisons, 1);
+        if (pattern[j] == text[i]) {
+            i++;
+            j++;
+        }
+        if (j == m) {
+            matches.push_back(i - j);
+            j = lps[j - 1];
+            SW_STAT_ADD(kmpFallbackShifts, 1);
+        }
+        else if (i < n) {
+            SW_STAT_ADD(charComparisons, 1);
+            if (pattern[j] != text[i]) {
+                if (j != 0) {
+                    j = lps[j - 1];
+                    SW_STAT_ADD(kmpFallbackShifts, 1);
+                }
+                else {
+                    i++;
+                }
+            }
+        }
+    }
+    return matches;
+}
+
+// --- 3. Rabin-Karp Algorithm (with Adaptive Switching Logic) ---
+
+inline std::vector<int> rabinKarpSearch(const std::string& text, const std::string& pattern, int startIndex,
+    int& lastCheckedIndex, bool& switchRequired) {
+    SW_STATS_BEGIN();
+    const long long d = 256; // Number of characters in the alphabet (256 for ASCII)
+    const long long q = 101; // A small prime for simplicity
+    std::vector<int> matches;
+    int n = text.length();
+    int m = pattern.length();
+    long long pHash = 0; // hash value for pattern
+    long long tHash = 0; // hash value for text window
+    long long h = 1;     // d^(m-1) % q
+
+    // *** CHANGE 2: Spurious hit limit changed from 5 to 3 ***
+    int SPURIOUS_HIT_LIMIT = 3; // Adaptive switching threshold
+    int spuriousHits = 0;
+    switchRequired = false;
+    lastCheckedIndex = startIndex;
+
+    // Handle edge case where text is shorter than pattern
+    if (n < m + startIndex) {
+        return matches;
+    }
+
+    // Calculate h = d^(m-1) % q
+    for (int i = 0; i < m - 1; ++i) {
+        h = (h * d) % q;
+    }
+
+    // Calculate initial hashes
+    for (int i = 0; i < m; ++i) {
+        pHash = (d * pHash + pattern[i]) % q;
+        tHash = (d * tHash + text[startIndex + i]) % q;
+    }
+
+    // Slide the pattern over the text
+    for (int i = startIndex; i <= n - m; ++i) {
+        lastCheckedIndex = i;
+        // Check if hashes match
+        if (pHash == tHash) {
+            // Hashes match, now verify characters (this is the O(m) check)
+            SW_STAT_ADD(hashVerifications, 1);
+            int j;
+            for (j = 0; j < m; ++j) {
+                if (text[i + j] != pattern[j]) {
+                    break;
+                }
+            }
+            SW_STAT_ADD(charComparisons, j < m ? j + 1 : m);
+
+            if (j == m) {
+                matches.push_back(i);
+            }
+            else {
+                // Spurious Hit!
+                spuriousHits++;
+                SW_STAT_ADD(spuriousHits, 1);
+                if (spuriousHits > SPURIOUS_HIT_LIMIT) {
+                    SW_STAT_ADD(bytesScanned, i + m - startIndex);
+                    SW_STAT_ADD(rabinKarpSwitches, 1);
+                    switchRequired = true;
+                    return matches; // Give up and signal a switch
+                }
+            }
+        }
+
+        // Calculate hash for the next window
+        if (i < n - m) {
+            tHash = (d * (tHash - text[i] * h) + text[i + m]) % q;
+            // We might get a negative tHash, convert it to positive
+            if (tHash < 0) {
+                tHash = (tHash + q);
+            }
+        }
+    }
+    SW_STAT_ADD(bytesScanned, n - startIndex);
+    return matches;
+}
+
+
+// --- 4. The Adaptive Algorithmic Framework ---
+
+enum class Algorithm { NAIVE, KMP, RABIN_KARP };
+
+inline Algorithm chooseAlgorithm(int m, int k, std::ostream* log = nullptr) {
+    // *** CHANGE 3: Naive threshold changed to m < 6 ***
+    if (m < 6) {
+        if (log) *log << "Decision: Tiny pattern (m=" << m << "). Using Naive." << std::endl;
+        return Algorithm::NAIVE;
+    }
+    if (k <= 4) {
+        if (log) *log << "Decision: Small alphabet (k=" << k << "). Using KMP." << std::endl;
+        return Algorithm::KMP;
+    }
+    if (k >= 64) {
+        if (log) *log << "Decision: Large alphabet (k=" << k << "). Trying Rabin-Karp." << std::endl;
+        return Algorithm::RABIN_KARP;
+    }
+    if (log) *log << "Decision: Default case (m=" << m << ", k=" << k << "). Using KMP for safety." << std::endl;
+    return Algorithm::KMP;
+}
+
+/**
+ * Deliverable 1: The main adaptive strategy function.
+ * Progress and decisions are written to `log` when one is given.
+ */
+inline std::vector<int> adaptiveStringSearch(const std::string& text, const std::string& pattern, int alphabetSize,
+    std::ostream* log = nullptr) {
+    if (log) *log << "--- Starting Adaptive Search ---" << std::endl;
+    int m = pattern.length();
+    // Handle empty pattern case
+    if (m == 0) {
+        if (log) *log << "--- Adaptive Search Complete ---" << std::endl;
+        return {};
+    }
+    Algorithm choice = chooseAlgorithm(m, alphabetSize, log);
+
+    if (choice == Algorithm::NAIVE) {
+        return naiveSearch(text, pattern);
+    }
+
+    if (choice == Algorithm::KMP) {
+        return kmpSearch(text, pattern);
+    }
+
+    if (choice == Algorithm::RABIN_KARP) {
+        bool switchRequired = false;
+        int lastCheckedIndex = 0;
+
+        // 1. Try Rabin-Karp
+        std::vector<int> matches = rabinKarpSearch(text, pattern, 0, lastCheckedIndex, switchRequired);
+
+        // 2. Check for Task 3: Adaptive Switch
+        if (switchRequired) {
+            if (log) *log << "!!! Rabin-Karp hit threshold at index " << lastCheckedIndex << ". Switching to KMP. !!!" << std::endl;
+
+            // 3. Run KMP on the *remainder* of the text
+            // We start KMP just *after* where RK left off to avoid redundant checks
+            std::vector<int> kmp_matches = kmpSearch(text, pattern, lastCheckedIndex + 1);
+
+            // 4. Combine results
+            matches.insert(matches.end(), kmp_matches.begin(), kmp_matches.end());
+        }
+
+        if (log) *log << "--- Adaptive Search Complete ---" << std::endl;
+        return matches;
+    }
+    return {}; // Should not happen
+}
+
+
+
+inline std::vector<int> searchMultiplePatterns(const std::string& text, const std::vector<std::string>& patterns,
+    std::ostream* log = nullptr) {
+    if (log) *log << "\n--- Task 2: Multi-Pattern Search (R-K method) ---" << std::endl;
+    // This implementation assumes all patterns have the *same length* m
+    // (A full Aho-Corasick would handle variable lengths)
+
+    if (patterns.empty()) return {};
+    int m = patterns[0].length();
+    if (m == 0) return {};
+
+    // Handle edge case where text is shorter than pattern
+    if ((int)text.length() < m) {
+        return {};
+    }
+
+    // Same hash parameters as rabinKarpSearch
+    const long long d = 256;
+    const long long q = 101;
+
+    // 1. Preprocessing: Hash all patterns and store in a set
+    std::unordered_set<long long> patternHashes;
+    for (const std::string& pattern : patterns) {
+        long long pHash = 0;
+        for (int i = 0; i < m; ++i) {
+            pHash = (d * pHash + pattern[i]) % q;
+        }
+        patternHashes.insert(pHash);
+    }
+    if (log) *log << "Hashed " << patterns.size() << " patterns into a set." << std::endl;
+
+    // 2. Search: Single pass over the text
+    SW_STATS_BEGIN();
+    std::vector<int> matches;
+    int n = text.length();
+    SW_STAT_ADD(bytesScanned, n);
+    long long tHash = 0;
+    long long h = 1;
+    for (int i = 0; i < m - 1; ++i) h = (h * d) % q;
+    for (int i = 0; i < m; ++i) tHash = (d * tHash + text[i]) % q;
+
+    for (int i = 0; i <= n - m; ++i) {
+        // Check if text hash is in the set of pattern hashes
+        if (patternHashes.count(tHash)) {
+   
+            matches.push_back(i);
+        }
+
+        // Roll the hash
+        if (i < n - m) {
+            tHash = (d * (tHash - text[i] * h) + text[i + m]) % q;
+            if (tHash < 0) tHash = (tHash + q);
+        }
+    }
+    return matches;
+}
+
+} // namespace stringworks
@@ -0,0 +1,217 @@
+#pragma once
+
+// LZ77 factorization driven by the suffix array (KKP style).
+//
+// One left-to-right pass over the suffix array with a stack gives, for every
+// text position i, the nearest suffixes before and after it in SA order that
+// start earlier in the text (PSV / NSV), together with their LCP with suffix i
+// (minimums over the LCP array, carried on the stack). The longest previous
+// factor at i is the larger of those two LCPs, so the factorization itself
+// needs no character comparisons.
+//
+// Token format written by lz77Compress (varints are LEB128):
+//   "LZ77", varint original length, then tokens until the text is complete:
+//     varint (count << 1)     followed by `count` literal bytes
+//     varint (length << 1 | 1) followed by varint distance (1 = previous byte)
+// Copies may overlap their own output. Malformed input to lz77Decompress is
+// reported with std::runtime_error.
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+#include "SuffixArrayDC.h"
+#include "BWTCodec.h"
+
+namespace stringworks {
+
+struct LZFactor {
+    int source;   // Earlier text position to copy from; -1 for a literal
+    int length;   // Copy length; 1 for a literal
+    char literal; // Only meaningful when source == -1
+};
+
+struct RepetitivenessStats {
+    int64_t length = 0;        // n
+    int64_t factors = 0;       // z, LZ77 phrases (literals included)
+    int64_t literals = 0;      // Phrases with no earlier occurrence
+    int64_t bwtRuns = 0;       // r, runs in the BWT (sentinel counted once)
+    double meanFactorLength = 0;
+    size_t lzBytes = 0;        // Size of lz77Compress output
+    size_t bwtBytes = 0;       // Size of the BWT as CompressedCorpus stores it (encodeBWTBlock)
+    bool preferBWT = false;    // Smaller of the two encodings
+};
+
+namespace lz_detail {
+
+inline void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += (char)((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += (char)value;
+}
+
+inline uint64_t getVarint(const std::string& in, size_t& pos) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= in.size()) throw std::runtime_error("lz77: truncated varint");
+        unsigned char b = in[pos++];
+        value |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return value;
+    }
+    throw std::runtime_error("lz77: varint too long");
+}
+
+} // namespace lz_detail
+
+// PSV/NSV text positions of every suffix and their LCPs with it (-1 / 0 if none).
+inline void buildPSVNSV(const std::vector<int>& suffixArr, const std::vector<int>& lcpArr,
+    std::vector<int>& psv, std::vector<int>& psvLCP, std::vector<int>& nsv, std::vector<int>& nsvLCP) {
+    int n = suffixArr.size();
+    psv.assign(n, -1);
+    nsv.assign(n, -1);
+    psvLCP.assign(n, 0);
+    nsvLCP.assign(n, 0);
+
+    // Stack of (text position, LCP with the entry below it); text positions increase upwards
+    std::vector<std::pair<int, int>> stack = { { -1, 0 } };
+    for (int r = 0; r <= n; ++r) {
+        int cur = r < n ? suffixArr[r] : -1;
+        int curLCP = r < n && r > 0 ? lcpArr[r] : 0; // LCP with the stack top (SA[r - 1])
+        while (stack.back().first > cur) {
+            std::pair<int, int> x = stack.back();
+            stack.pop_back();
+            nsv[x.first] = cur;
+            nsvLCP[x.first] = cur < 0 ? 0 : curLCP;
+            psv[x.first] = stack.back().first;
+            psvLCP[x.first] = stack.back().first < 0 ? 0 : x.second;
+            curLCP = std::min(curLCP, x.second);
+        }
+        if (r < n) stack.push_back({ cur, curLCP });
+    }
+}
+
+/**
+ * Greedy LZ77 factorization of text, given its suffix array and LCP array
+ * (as built by buildSuffixArrayDC or buildSuffixArrayDoubling, and
+ * buildLCPArray). O(n) after SA and LCP.
+ */
+inline std::vector<LZFactor> lz77Factorize(const std::string& text, const std::vector<int>& suffixArr, const std::vector<int>& lcpArr) {
+    std::vector<int> psv, psvLCP, nsv, nsvLCP;
+    buildPSVNSV(suffixArr, lcpArr, psv, psvLCP, nsv, nsvLCP);
+
+    std::vector<LZFactor> factors;
+    int n = text.length();
+    for (int i = 0; i < n;) {
+        bool usePrevious = psvLCP[i] >= nsvLCP[i];
+        int length = usePrevious ? psvLCP[i] : nsvLCP[i];
+        if (length == 0) {
+            factors.push_back({ -1, 1, text[i] });
+            i++;
+        }
+        else {
+            factors.push_back({ usePrevious ? psv[i] : nsv[i], length, '\0' });
+            i += length;
+        }
+    }
+    return factors;
+}
+
+inline std::string lz77Encode(const std::string& text, const std::vector<LZFactor>& factors) {
+    std::string out = "LZ77";
+    lz_detail::putVarint(out, text.size());
+    int pos = 0;
+    for (size_t f = 0; f < factors.size();) {
+        if (factors[f].source < 0) {
+            // Group consecutive literals into one token
+            size_t end = f;
+            while (end < factors.size() && factors[end].source < 0) end++;
+            lz_detail::putVarint(out, (uint64_t)(end - f) << 1);
+            out.append(text, pos, end - f);
+            pos += end - f;
+            f = end;
+        }
+        else {
+            lz_detail::putVarint(out, ((uint64_t)factors[f].length << 1) | 1);
+            lz_detail::putVarint(out, pos - factors[f].source);
+            pos += factors[f].length;
+            f++;
+        }
+    }
+    return out;
+}
+
+// Builds SA (by prefix doubling) and LCP (Kasai), so compression stays
+// O(n log n) on the repetitive inputs where LZ77 pays off.
+inline std::string lz77Compress(const std::string& text) {
+    std::vector<int> suffixArr = buildSuffixArrayDoubling(text);
+    std::vector<int> lcpArr = buildLCPArray(text, suffixArr);
+    return lz77Encode(text, lz77Factorize(text, suffixArr, lcpArr));
+}
+
+inline std::string lz77Decompress(const std::string& data) {
+    if (data.compare(0, 4, "LZ77") != 0) throw std::runtime_error("lz77: bad magic");
+    size_t pos = 4;
+    uint64_t length = lz_detail::getVarint(data, pos);
+    std::string out;
+    if (length > out.max_size()) throw std::runtime_error("lz77: bad original length");
+    // The header is not trusted for the allocation; copies may still grow the output further
+    out.reserve(std::min<uint64_t>(length, (uint64_t)data.size() * 8));
+    while (out.size() < length) {
+        uint64_t tag = lz_detail::getVarint(data, pos);
+        uint64_t count = tag >> 1;
+        if (count == 0 || count > length - out.size()) throw std::runtime_error("lz77: bad token length");
+        if (tag & 1) {
+            uint64_t distance = lz_detail::getVarint(data, pos);
+            if (distance == 0 || distance > out.size()) throw std::runtime_error("lz77: bad copy distance");
+            size_t from = out.size() - distance;
+            for (uint64_t k = 0; k < count; ++k) out += out[from + k]; // May overlap
+        }
+        else {
+            if (count > data.size() - pos) throw std::runtime_error("lz77: truncated literals");
+            out.append(data, pos, count);
+            pos += count;
+        }
+    }
+    return out;
+}
+
+/**
+ * Repetitiveness of text (z, r and both encoded sizes), for choosing between
+ * BWT- and LZ-based compression of a block.
+ */
+inline RepetitivenessStats analyzeRepetitiveness(const std::string& text, const std::vector<int>& suffixArr,
+    const std::vector<int>& lcpArr) {
+    RepetitivenessStats stats;
+    stats.length = text.length();
+    std::vector<LZFactor> factors = lz77Factorize(text, suffixArr, lcpArr);
+    stats.factors = factors.size();
+    for (const LZFactor& f : factors) stats.literals += f.source < 0;
+    stats.meanFactorLength = factors.empty() ? 0 : (double)stats.length / factors.size();
+    stats.lzBytes = lz77Encode(text, factors).size();
+
+    // BWT runs; the row of suffix 0 holds the (unique) sentinel
+    int n = text.length();
+    std::string rows(n, '\0');
+    uint64_t primary = 0;
+    for (int i = 0; i < n; ++i) {
+        if (suffixArr[i] == 0) primary = i;
+        else rows[i] = text[suffixArr[i] - 1];
+    }
+    for (int i = 0; i < n;) {
+        int j = i + 1;
+        if (suffixArr[i] != 0) {
+            while (j < n && suffixArr[j] != 0 && rows[j] == rows[i]) j++;
+        }
+        stats.bwtRuns++;
+        i = j;
+    }
+    stats.bwtBytes = n > 0 ? encodeBWTBlock(rows, primary).size() : 0;
+    stats.preferBWT = stats.bwtBytes < stats.lzBytes;
+    return stats;
+}
+
+} // namespace stringworks
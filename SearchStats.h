@@ -0,0 +1,115 @@
+#pragma once
+
+// Hot-path counters for the search engines.
+//
+// Counting is compiled in only when STRINGWORKS_STATS is defined (CMake option
+// STRINGWORKS_STATS=ON). Otherwise SW_STATS_BEGIN and SW_STAT_ADD expand to
+// nothing and StatsScope is an empty object, so the engines pay nothing.
+//
+// Usage: open a StatsScope around one query; every engine running on that
+// thread while the scope is alive adds into the given SearchStats. Engines
+// that fan out to worker threads collect per-thread stats and merge them back
+// with SW_STATS_MERGE.
+//
+//     SearchStats stats;
+//     {
+//         StatsScope scope(stats, "kmp");
+//         kmpSearch(text, pattern);
+//     }
+//     cout << stats.toJson() << endl;
+
+#include <string>
+#include <cstdint>
+#include <chrono>
+
+namespace stringworks {
+
+struct SearchStats {
+    std::string engine;
+    uint64_t charComparisons = 0;   // Text/pattern character comparisons
+    uint64_t hashVerifications = 0; // Hash hits checked against the text
+    uint64_t spuriousHits = 0;      // Hash hits that were not matches
+    uint64_t kmpFallbackShifts = 0; // j = lps[j - 1] steps in KMP
+    uint64_t rabinKarpSwitches = 0; // Rabin-Karp runs handed over to KMP
+    uint64_t failureLinkHops = 0;   // Aho-Corasick output-chain link follows
+    uint64_t suffixComparisons = 0; // isSmaller calls made by merge
+    uint64_t bytesScanned = 0;      // Input bytes the engine walked over
+    double elapsedMs = 0;           // Wall time of the enclosing StatsScope
+
+    // Adds another thread's counters (not its elapsed time, which overlaps ours).
+    void add(const SearchStats& other) {
+        charComparisons += other.charComparisons;
+        hashVerifications += other.hashVerifications;
+        spuriousHits += other.spuriousHits;
+        kmpFallbackShifts += other.kmpFallbackShifts;
+        rabinKarpSwitches += other.rabinKarpSwitches;
+        failureLinkHops += other.failureLinkHops;
+        suffixComparisons += other.suffixComparisons;
+        bytesScanned += other.bytesScanned;
+    }
+
+    std::string toJson() const {
+        return "{\"engine\":\"" + engine + "\""
+            + ",\"charComparisons\":" + std::to_string(charComparisons)
+            + ",\"hashVerifications\":" + std::to_string(hashVerifications)
+            + ",\"spuriousHits\":" + std::to_string(spuriousHits)
+            + ",\"kmpFallbackShifts\":" + std::to_string(kmpFallbackShifts)
+            + ",\"rabinKarpSwitches\":" + std::to_string(rabinKarpSwitches)
+            + ",\"failureLinkHops\":" + std::to_string(failureLinkHops)
+            + ",\"suffixComparisons\":" + std::to_string(suffixComparisons)
+            + ",\"bytesScanned\":" + std::to_string(bytesScanned)
+            + ",\"elapsedMs\":" + std::to_string(elapsedMs) + "}";
+    }
+};
+
+#ifdef STRINGWORKS_STATS
+
+constexpr bool statsEnabled = true;
+
+// The SearchStats receiving this thread's counters, or nullptr outside a scope.
+inline SearchStats*& activeStats() {
+    thread_local SearchStats* stats = nullptr;
+    return stats;
+}
+
+class StatsScope {
+private:
+    SearchStats& stats;
+    SearchStats* previous;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    StatsScope(SearchStats& stats, const std::string& engine)
+        : stats(stats), previous(activeStats()), start(std::chrono::steady_clock::now()) {
+        stats.engine = engine;
+        activeStats() = &stats;
+    }
+    ~StatsScope() {
+        stats.elapsedMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        activeStats() = previous;
+    }
+    StatsScope(const StatsScope&) = delete;
+    StatsScope& operator=(const StatsScope&) = delete;
+};
+
+// Looks up the active stats once per function; SW_STAT_ADD then costs a branch.
+#define SW_STATS_BEGIN() ::stringworks::SearchStats* swStats_ = ::stringworks::activeStats()
+#define SW_STAT_ADD(field, n) do { if (swStats_) swStats_->field += (n); } while (0)
+#define SW_STATS_MERGE(other) do { if (swStats_) swStats_->add(other); } while (0)
+
+#else
+
+constexpr bool statsEnabled = false;
+
+class StatsScope {
+public:
+    StatsScope(SearchStats&, const std::string&) {}
+};
+
+#define SW_STATS_BEGIN() ((void)0)
+#define SW_STAT_ADD(field, n) ((void)0)
+#define SW_STATS_MERGE(other) ((void)0)
+
+#endif
+
+} // namespace stringworks
@@ -0,0 +1,204 @@
+#pragma once
+
+// Suffix array built with a merge-sort style divide and conquer over suffix
+// indices (or by prefix doubling for long, repetitive inputs), plus the LCP
+// array and Burrows-Wheeler Transform derived from it.
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "SearchStats.h"
+
+namespace stringworks {
+
+// --- Helper: Compare two suffixes explicitly ---
+// Returns true if suffix at index i is lexicographically smaller than suffix at index j
+inline bool isSmaller(const std::string& text, int i, int j) {
+    int n = text.length();
+    while (i < n && j < n) {
+        if (text[i] < text[j]) return true;
+        if (text[i] > text[j]) return false;
+        i++;
+        j++;
+    }
+    // If one runs out, the shorter one is "smaller"
+    return i == n && j < n;
+}
+
+// --- PART 1: DIVIDE AND CONQUER (Merge Sort) ---
+
+// The "Merge" step of Divide and Conquer
+inline void merge(const std::string& text, std::vector<int>& suffixes, int left, int mid, int right) {
+    SW_STATS_BEGIN();
+    int n1 = mid - left + 1;
+    int n2 = right - mid;
+
+    // Create temp arrays
+    std::vector<int> L(n1), R(n2);
+
+    for (int i = 0; i < n1; i++)
+        L[i] = suffixes[left + i];
+    for (int j = 0; j < n2; j++)
+        R[j] = suffixes[mid + 1 + j];
+
+    // Merge the temp arrays back into suffixes[left..right]
+    int i = 0, j = 0, k = left;
+    while (i < n1 && j < n2) {
+        // CRITICAL: String comparison happens here
+        SW_STAT_ADD(suffixComparisons, 1);
+        if (isSmaller(text, L[i], R[j])) {
+            suffixes[k] = L[i];
+            i++;
+        }
+        else {
+            suffixes[k] = R[j];
+            j++;
+        }
+        k++;
+    }
+
+    // Copy remaining elements
+    while (i < n1) {
+        suffixes[k] = L[i];
+        i++;
+        k++;
+    }
+    while (j < n2) {
+        suffixes[k] = R[j];
+        j++;
+        k++;
+    }
+}
+
+// The Recursive "Divide" step
+inline void mergeSortSuffixes(const std::string& text, std::vector<int>& suffixes, int left, int right) {
+    if (left < right) {
+        int mid = left + (right - left) / 2;
+
+        // DIVIDE: Recursively sort first and second halves
+        mergeSortSuffixes(text, suffixes, left, mid);
+        mergeSortSuffixes(text, suffixes, mid + 1, right);
+
+        // COMBINE: Merge the sorted halves
+        merge(text, suffixes, left, mid, right);
+    }
+}
+
+// Wrapper function to start the D&C process
+inline std::vector<int> buildSuffixArrayDC(const std::string& text) {
+    SW_STATS_BEGIN();
+    int n = text.length();
+    SW_STAT_ADD(bytesScanned, n);
+    std::vector<int> suffixes(n);
+    // Initialize with indices 0 to n-1
+    for (int i = 0; i < n; i++) suffixes[i] = i;
+
+    // Start Divide and Conquer
+    mergeSortSuffixes(text, suffixes, 0, n - 1);
+    return suffixes;
+}
+
+// --- Prefix doubling (O(n log n), for long or highly repetitive texts) ---
+
+// Same order as buildSuffixArrayDC, but suffixes are ranked by their first
+// 2h characters from the ranks of their first h, with two counting-sort
+// passes per round, so no suffixes are compared character by character.
+inline std::vector<int> buildSuffixArrayDoubling(const std::string& text) {
+    SW_STATS_BEGIN();
+    int n = text.length();
+    SW_STAT_ADD(bytesScanned, n);
+    std::vector<int> suffixes(n), rank(n), sorted(n), newRank(n);
+    if (n == 0) return suffixes;
+
+    // Round 0: rank by the first character, in the signed char order of isSmaller
+    for (int i = 0; i < n; i++) rank[i] = (int)(signed char)text[i] + 128;
+    int classes = 256;
+    std::vector<int> count;
+
+    // Counting sort of `from` by key(i) into `to` (stable)
+    auto countingSort = [&](const std::vector<int>& from, std::vector<int>& to, auto key) {
+        count.assign(classes + 1, 0);
+        for (int i : from) count[key(i) + 1]++;
+        for (int c = 1; c <= classes; c++) count[c] += count[c - 1];
+        for (int i : from) to[count[key(i)]++] = i;
+    };
+
+    for (int i = 0; i < n; i++) sorted[i] = i;
+    countingSort(sorted, suffixes, [&](int i) { return rank[i]; });
+
+    for (int h = 0;; h = h == 0 ? 1 : 2 * h) {
+        if (h > 0) {
+            // Second key first: suffixes with no characters past h come first
+            int k = 0;
+            for (int i = n - h; i < n; i++) sorted[k++] = i;
+            for (int i = 0; i < n; i++)
+                if (suffixes[i] >= h) sorted[k++] = suffixes[i] - h;
+            countingSort(sorted, suffixes, [&](int i) { return rank[i]; });
+        }
+
+        // Re-rank by (rank[i], rank[i + h]); -1 stands for "past the end"
+        auto second = [&](int i) { return h > 0 && i + h < n ? rank[i + h] : -1; };
+        newRank[suffixes[0]] = 0;
+        for (int i = 1; i < n; i++) {
+            int a = suffixes[i - 1], b = suffixes[i];
+            bool same = rank[a] == rank[b] && second(a) == second(b);
+            newRank[b] = newRank[a] + (same ? 0 : 1);
+        }
+        rank.swap(newRank);
+        classes = rank[suffixes[n - 1]] + 1;
+        if (classes == n || (h > 0 && h >= n)) break;
+    }
+    return suffixes;
+}
+
+// --- PART 2: FIND REPETITIONS (LCP Calculation) ---
+
+// Calculates Longest Common Prefix between two specific suffixes
+inline int computeLCP(const std::string& text, int i, int j) {
+    int n = text.length();
+    int len = 0;
+    while (i + len < n && j + len < n && text[i + len] == text[j + len]) {
+        len++;
+    }
+    return len;
+}
+
+// Builds the LCP array based on the sorted Suffix Array.
+// lcp[i] = LCP(suffixArr[i - 1], suffixArr[i]), computed with Kasai's algorithm:
+// walking the suffixes in text order, the LCP with the SA predecessor drops by
+// at most one per step, so the whole array costs O(n) character comparisons.
+inline std::vector<int> buildLCPArray(const std::string& text, const std::vector<int>& suffixArr) {
+    int n = text.length();
+    std::vector<int> lcp(n, 0);
+    std::vector<int> rank(n);
+    for (int i = 0; i < n; i++) rank[suffixArr[i]] = i;
+
+    int len = 0;
+    for (int pos = 0; pos < n; pos++) {
+        if (rank[pos] == 0) {
+            len = 0;
+            continue;
+        }
+        int previous = suffixArr[rank[pos] - 1];
+        while (pos + len < n && previous + len < n && text[pos + len] == text[previous + len])
+            len++;
+        lcp[rank[pos]] = len;
+        if (len > 0) len--;
+    }
+    return lcp;
+}
+
+// --- PART 3: COMPRESSION OUTPUTS ---
+
+inline std::string buildBWT(const std::string& text, const std::vector<int>& suffixArr) {
+    int n = text.length();
+    std::string bwt = "";
+    for (int i = 0; i < n; i++) {
+        if (suffixArr[i] == 0) bwt += text[n - 1];
+        else bwt += text[suffixArr[i] - 1];
+    }
+    return bwt;
+}
+
+} // namespace stringworks
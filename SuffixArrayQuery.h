@@ -0,0 +1,200 @@
+#pragma once
+
+// Pattern queries over a prebuilt suffix array (Manber-Myers).
+//
+// SuffixArrayIndex precomputes, for every midpoint M of the fixed binary
+// search over SA positions, the LCP between M and the two ends of its search
+// interval (derived from the LCP array in O(n)). A lookup then compares each
+// pattern character at most once, so count/locate cost O(m + log n).
+//
+// Batches are sorted first: duplicate patterns are answered once, and a
+// pattern that extends an earlier one in the batch is searched only inside
+// that pattern's SA interval, starting after the shared prefix. Sorted chunks
+// are spread across threads.
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+
+#include "SearchStats.h"
+
+namespace stringworks {
+
+struct PatternMatches {
+    int count = 0;
+    std::vector<int> positions; // Ascending; filled only when locating
+};
+
+class SuffixArrayIndex {
+private:
+    std::string_view text;              // The caller keeps text and SA alive
+    const std::vector<int>& suffixArr;
+    int n;
+    std::vector<int> llcp;              // LCP(suffix L, suffix M) for midpoint M of interval (L, R)
+    std::vector<int> rlcp;              // LCP(suffix M, suffix R) for the same interval
+
+    // Returns LCP(suffix L, suffix R); L = -1 and R = n are virtual bounds.
+    int buildIntervalLCP(const std::vector<int>& lcpArr, int L, int R) {
+        bool virtualBound = L < 0 || R >= n;
+        if (R - L <= 1)
+            return virtualBound ? 0 : lcpArr[R];
+        int M = L + (R - L) / 2;
+        llcp[M] = buildIntervalLCP(lcpArr, L, M);
+        rlcp[M] = buildIntervalLCP(lcpArr, M, R);
+        return virtualBound ? 0 : std::min(llcp[M], rlcp[M]);
+    }
+
+    // Extends the common prefix of pattern and the suffix at SA position i from `from`.
+    int extend(std::string_view pattern, int i, int from) const {
+        SW_STATS_BEGIN();
+        int pos = suffixArr[i];
+        int k = from;
+        while (k < (int)pattern.size() && pos + k < n && text[pos + k] == pattern[k])
+            k++;
+        SW_STAT_ADD(charComparisons, k - from + 1);
+        return k;
+    }
+
+    // Whether the suffix at SA position i sorts before the boundary, given that
+    // it agrees with the pattern on exactly k characters. For the upper boundary
+    // a suffix that starts with the pattern still counts as "before".
+    bool suffixBefore(std::string_view pattern, int i, int k, bool upper) const {
+        if (k == (int)pattern.size()) return upper;
+        int pos = suffixArr[i];
+        if (pos + k == n) return true;  // Suffix is a proper prefix of the pattern
+        return text[pos + k] < pattern[k]; // Same char ordering as isSmaller
+    }
+
+    // Manber-Myers search over the whole array using llcp/rlcp to skip comparisons.
+    int boundary(std::string_view pattern, bool upper) const {
+        int L = -1, R = n;
+        int l = 0, r = 0; // lcp(pattern, suffix L) and lcp(pattern, suffix R)
+        while (R - L > 1) {
+            int M = L + (R - L) / 2;
+            int from;
+            if (l >= r) {
+                if (llcp[M] > l) { L = M; continue; }
+                if (llcp[M] < l) { R = M; r = llcp[M]; continue; }
+                from = l;
+            }
+            else {
+                if (rlcp[M] > r) { R = M; continue; }
+                if (rlcp[M] < r) { L = M; l = rlcp[M]; continue; }
+                from = r;
+            }
+            int k = extend(pattern, M, from);
+            if (suffixBefore(pattern, M, k, upper)) { L = M; l = k; }
+            else { R = M; r = k; }
+        }
+        return R;
+    }
+
+    // Binary search inside [lo, hi), where every suffix already shares the
+    // first `known` characters with the pattern.
+    int boundaryWithin(std::string_view pattern, int lo, int hi, int known, bool upper) const {
+        int L = lo - 1, R = hi;
+        int l = known, r = known;
+        while (R - L > 1) {
+            int M = L + (R - L) / 2;
+            int k = extend(pattern, M, std::min(l, r));
+            if (suffixBefore(pattern, M, k, upper)) { L = M; l = k; }
+            else { R = M; r = k; }
+        }
+        return R;
+    }
+
+    void collect(int lo, int hi, bool locate, PatternMatches& out) const {
+        out.count = hi - lo;
+        if (!locate) return;
+        out.positions.assign(suffixArr.begin() + lo, suffixArr.begin() + hi);
+        std::sort(out.positions.begin(), out.positions.end());
+    }
+
+public:
+    SuffixArrayIndex(std::string_view text, const std::vector<int>& suffixArr, const std::vector<int>& lcpArr)
+        : text(text), suffixArr(suffixArr), n(suffixArr.size()), llcp(n, 0), rlcp(n, 0) {
+        buildIntervalLCP(lcpArr, -1, n);
+    }
+
+    // Half-open range of SA positions whose suffixes start with the pattern.
+    std::pair<int, int> findRange(std::string_view pattern) const {
+        return { boundary(pattern, false), boundary(pattern, true) };
+    }
+
+    int count(std::string_view pattern) const {
+        std::pair<int, int> range = findRange(pattern);
+        return range.second - range.first;
+    }
+
+    std::vector<int> locate(std::string_view pattern) const {
+        PatternMatches result;
+        std::pair<int, int> range = findRange(pattern);
+        collect(range.first, range.second, true, result);
+        return result.positions;
+    }
+
+    // Answers every pattern; results are in the order of `patterns`.
+    // threads <= 0 uses the hardware concurrency.
+    std::vector<PatternMatches> queryBatch(const std::vector<std::string>& patterns, bool locate, int threads = 0) const {
+        std::vector<PatternMatches> results(patterns.size());
+        std::vector<int> order(patterns.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return patterns[a] < patterns[b]; });
+
+        auto runChunk = [&](size_t begin, size_t end) {
+            // Earlier patterns of this chunk that may be prefixes of the next one
+            struct Interval { int query; int lo; int hi; };
+            std::vector<Interval> stack;
+            for (size_t k = begin; k < end; ++k) {
+                const std::string& pattern = patterns[order[k]];
+                while (!stack.empty()) {
+                    const std::string& prev = patterns[stack.back().query];
+                    if (prev.size() <= pattern.size() && pattern.compare(0, prev.size(), prev) == 0) break;
+                    stack.pop_back();
+                }
+
+                int lo, hi;
+                if (stack.empty()) {
+                    lo = boundary(pattern, false);
+                    hi = boundary(pattern, true);
+                }
+                else if (patterns[stack.back().query].size() == pattern.size()) {
+                    lo = stack.back().lo; // Duplicate pattern
+                    hi = stack.back().hi;
+                }
+                else {
+                    const Interval& outer = stack.back();
+                    int known = patterns[outer.query].size();
+                    lo = boundaryWithin(pattern, outer.lo, outer.hi, known, false);
+                    hi = boundaryWithin(pattern, lo, outer.hi, known, true);
+                }
+                collect(lo, hi, locate, results[order[k]]);
+                stack.push_back({ order[k], lo, hi });
+            }
+        };
+
+        if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        size_t chunks = std::min<size_t>(threads, std::max<size_t>(patterns.size() / 64, 1));
+        size_t chunkSize = (patterns.size() + chunks - 1) / chunks;
+        std::vector<std::thread> pool;
+        std::vector<SearchStats> chunkStats(chunks); // Workers' counters, merged into the caller's
+        for (size_t c = 1; c < chunks; ++c) {
+            size_t begin = c * chunkSize;
+            pool.emplace_back([&, c, begin]() {
+                StatsScope scope(chunkStats[c], "sa-query");
+                runChunk(begin, std::min(patterns.size(), begin + chunkSize));
+            });
+        }
+        runChunk(0, std::min(patterns.size(), chunkSize));
+        for (std::thread& th : pool) th.join();
+
+        SW_STATS_BEGIN();
+        for (size_t c = 1; c < chunks; ++c) SW_STATS_MERGE(chunkStats[c]);
+        return results;
+    }
+};
+
+} // namespace stringworks
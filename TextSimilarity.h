@@ -0,0 +1,408 @@
+#pragma once
+
+// Document similarity: longest common substring by binary search over length
+// with a Rabin-Karp checker, maximal common substrings with shingle scores for
+// one-vs-many comparison, and MinHash/LSH near-duplicate detection over a corpus.
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstring>     // For memcmp
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_set>
+
+#include "SearchStats.h"
+
+namespace stringworks {
+
+// Rabin-Karp rolling hash shared by the checker and the document index.
+struct RollingHash {
+    static constexpr long long d = 256;        // Base 
+    static constexpr long long q = 1000000007; // A large prime modulus (restored from 13)
+
+    // Calls f(index, hash) for every window of length K in s, left to right.
+    // Stops early as soon as f returns false.
+    template <typename F>
+    static void forEachWindowHash(std::string_view s, int K, F&& f) {
+        int n = s.length();
+        if (K <= 0 || K > n)
+            return;
+
+        long long h = 1; // d^(K-1) % q
+        for (int i = 0; i < K - 1; ++i) {
+            h = (h * d) % q;
+        }
+
+        long long currentHash = 0;
+        for (int i = 0; i < K; ++i) {
+            currentHash = (d * currentHash + (unsigned char)s[i]) % q;
+        }
+        if (!f(0, currentHash))
+            return;
+
+        for (int i = 0; i <= n - K - 1; ++i) {
+            currentHash = (d * (currentHash - (unsigned char)s[i] * h) + (unsigned char)s[i + K]) % q;
+            if (currentHash < 0) currentHash += q;
+            if (!f(i + 1, currentHash))
+                return;
+        }
+    }
+};
+
+// Chained hash table over the K-length windows of one document, sized once and
+// cleared (not reallocated) every time it is rebuilt for a new K.
+// head[] is the first position in each bucket, next[] chains positions of the
+// document, and hashAt[] lets a bucket walk reject other hashes before touching the text.
+class WindowHashTable {
+private:
+    std::vector<int> head;
+    std::vector<int> next;
+    std::vector<long long> hashAt;
+    size_t mask = 0;
+
+public:
+    explicit WindowHashTable(size_t docLength) {
+        size_t buckets = 1;
+        while (buckets < 2 * docLength) buckets <<= 1;
+        head.assign(buckets, -1);
+        next.assign(docLength, -1);
+        hashAt.assign(docLength, 0);
+        mask = buckets - 1;
+    }
+
+    void build(std::string_view doc, int K) {
+        std::fill(head.begin(), head.end(), -1);
+        RollingHash::forEachWindowHash(doc, K, [&](int i, long long hash) {
+            size_t bucket = (size_t)hash & mask;
+            hashAt[i] = hash;
+            next[i] = head[bucket];
+            head[bucket] = i;
+            return true;
+        });
+    }
+
+    // Calls f(index) for every indexed window whose hash equals `hash`.
+    // Returns false if f stopped the walk by returning false.
+    template <typename F>
+    bool forEachCandidate(long long hash, F&& f) const {
+        for (int i = head[(size_t)hash & mask]; i != -1; i = next[i]) {
+            if (hashAt[i] == hash && !f(i))
+                return false;
+        }
+        return true;
+    }
+};
+
+class RabinKarpChecker {
+private:
+    // Views only: the caller keeps both documents alive for the checker's lifetime.
+    std::string_view A, B;
+    WindowHashTable tableA;
+
+public:
+    RabinKarpChecker(std::string_view docA, std::string_view docB) : A(docA), B(docB), tableA(docA.length()) {}
+
+    // The Check(K) subproblem
+    bool check(int K) {
+        if (K == 0)
+            return true;
+        // Check for bounds early
+        if (K > (int)A.length() || K > (int)B.length())
+            return false;
+
+        // 1. Hashing Document A (reusing the table allocated by the constructor)
+        SW_STATS_BEGIN();
+        SW_STAT_ADD(bytesScanned, A.length() + B.length());
+        tableA.build(A, K);
+
+        // 2. Checking Document B, verifying candidates in place
+        bool found = false;
+        RollingHash::forEachWindowHash(B, K, [&](int indexB, long long hash) {
+            return tableA.forEachCandidate(hash, [&](int indexA) {
+                SW_STAT_ADD(hashVerifications, 1);
+                SW_STAT_ADD(charComparisons, K);
+                if (memcmp(A.data() + indexA, B.data() + indexB, K) == 0) {
+                    found = true; // Found a true match
+                    return false;
+                }
+                SW_STAT_ADD(spuriousHits, 1);
+                return true;
+            });
+        });
+
+        // 3. No match unless B's scan stopped early
+        return found;
+    }
+};
+
+
+inline int findLongestMatch(std::string_view docA, std::string_view docB) {
+    int n = docA.length();
+    int m = docB.length();
+    int low = 0;
+    int high = std::min(n, m);
+    int maxLen = 0;
+
+    RabinKarpChecker checker(docA, docB);
+
+    while (low <= high) {
+        int K = low + (high - low) / 2;
+
+        if (checker.check(K)) {
+            maxLen = K;       // This is a possible answer
+            low = K + 1;      // Try to find a longer one 
+        }
+        else {
+            high = K - 1;     // This length is too long
+        }
+    }
+
+    return maxLen;
+}
+
+// --- Document Comparison API ---
+
+// One maximal common substring: A[posA, posA + length) == B[posB, posB + length),
+// and it cannot be extended to the left or right in both documents.
+struct CommonSubstring {
+    int posA;
+    int posB;
+    int length;
+};
+
+struct SimilarityReport {
+    int longest = 0;                 // Longest match reported (0 if none reaches minLength)
+    std::vector<CommonSubstring> matches; // Longest first; ties by posA, then posB
+    double containment = 0.0;        // |S(A) n S(B)| / |S(B)| over minLength-shingles
+    double resemblance = 0.0;        // |S(A) n S(B)| / |S(A) u S(B)| over minLength-shingles
+};
+
+/**
+ * Preprocesses one document so it can be compared against many others.
+ * The minLength-gram table and A's shingle set are built once; compare()
+ * only scans the other document. Shingles are compared by hash, so the
+ * scores are estimates; matches are always verified against the text.
+ */
+class DocumentIndex {
+private:
+    std::string_view A;       // The caller keeps the document alive
+    int minLength;
+    WindowHashTable table;
+    std::vector<long long> shinglesA;   // Sorted distinct window hashes of A
+    std::vector<long long> shinglesB;   // Scratch buffer reused by compare()
+
+public:
+    DocumentIndex(std::string_view doc, int minLength)
+        : A(doc), minLength(std::max(1, minLength)), table(doc.length()) {
+        table.build(A, this->minLength);
+        RollingHash::forEachWindowHash(A, this->minLength, [&](int, long long hash) {
+            shinglesA.push_back(hash);
+            return true;
+        });
+        std::sort(shinglesA.begin(), shinglesA.end());
+        shinglesA.erase(std::unique(shinglesA.begin(), shinglesA.end()), shinglesA.end());
+    }
+
+    int minimumLength() const { return minLength; }
+
+    // Compares B against the indexed document. topK = 0 keeps every maximal
+    // match of at least minLength characters. Highly repetitive inputs can
+    // produce O(|A| * |B|) matches, so pass a topK when that matters.
+    SimilarityReport compare(std::string_view B, size_t topK = 0) {
+        SW_STATS_BEGIN();
+        SW_STAT_ADD(bytesScanned, B.length());
+        SimilarityReport report;
+        shinglesB.clear();
+
+        RollingHash::forEachWindowHash(B, minLength, [&](int indexB, long long hash) {
+            shinglesB.push_back(hash);
+            table.forEachCandidate(hash, [&](int indexA) {
+                // Only start at left-maximal pairs so every match is reported once
+                if (indexA > 0 && indexB > 0) {
+                    SW_STAT_ADD(charComparisons, 1);
+                    if (A[indexA - 1] == B[indexB - 1])
+                        return true;
+                }
+                SW_STAT_ADD(hashVerifications, 1);
+                SW_STAT_ADD(charComparisons, minLength);
+                if (memcmp(A.data() + indexA, B.data() + indexB, minLength) != 0) {
+                    SW_STAT_ADD(spuriousHits, 1);
+                    return true;
+                }
+
+                int len = minLength;
+                while (indexA + len < (int)A.length() && indexB + len < (int)B.length()
+                    && A[indexA + len] == B[indexB + len]) {
+                    len++;
+                }
+                SW_STAT_ADD(charComparisons, len - minLength + 1); // Extension, including the mismatch
+                report.matches.push_back({ indexA, indexB, len });
+                return true;
+            });
+            return true;
+        });
+
+        auto longerFirst = [](const CommonSubstring& x, const CommonSubstring& y) {
+            if (x.length != y.length) return x.length > y.length;
+            if (x.posA != y.posA) return x.posA < y.posA;
+            return x.posB < y.posB;
+        };
+        if (topK > 0 && topK < report.matches.size()) {
+            std::partial_sort(report.matches.begin(), report.matches.begin() + topK, report.matches.end(), longerFirst);
+            report.matches.resize(topK);
+        }
+        else {
+            std::sort(report.matches.begin(), report.matches.end(), longerFirst);
+        }
+        if (!report.matches.empty())
+            report.longest = report.matches[0].length;
+
+        // Shingle scores
+        std::sort(shinglesB.begin(), shinglesB.end());
+        shinglesB.erase(std::unique(shinglesB.begin(), shinglesB.end()), shinglesB.end());
+        size_t common = 0;
+        for (size_t i = 0, j = 0; i < shinglesA.size() && j < shinglesB.size();) {
+            if (shinglesA[i] < shinglesB[j]) i++;
+            else if (shinglesA[i] > shinglesB[j]) j++;
+            else { common++; i++; j++; }
+        }
+        size_t unionSize = shinglesA.size() + shinglesB.size() - common;
+        if (!shinglesB.empty())
+            report.containment = (double)common / shinglesB.size();
+        if (unionSize > 0)
+            report.resemblance = (double)common / unionSize;
+
+        return report;
+    }
+};
+
+// --- Corpus Near-Duplicate Detection ---
+
+struct CorpusOptions {
+    int shingleLength = 8;        // Window length fed to the rolling hash
+    int numHashes = 64;           // MinHash signature length
+    int bands = 16;               // LSH bands; rows per band = numHashes / bands
+    double minResemblance = 0.5;  // Drop candidates whose signature estimate is lower
+    int threads = 0;              // 0 = hardware concurrency
+};
+
+struct NearDuplicatePair {
+    int docA;
+    int docB;
+    double estimatedResemblance;  // Fraction of equal MinHash entries
+    int longestMatch;             // Exact, from findLongestMatch
+};
+
+// Runs f(i) for i in [0, count) on `threads` workers pulling from a shared counter.
+template <typename F>
+inline void parallelFor(size_t count, int threads, F&& f) {
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = (int)std::min<size_t>(threads, std::max<size_t>(count, 1));
+
+    std::atomic<size_t> nextIndex{ 0 };
+    auto worker = [&]() {
+        for (size_t i = nextIndex++; i < count; i = nextIndex++) f(i);
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (std::thread& th : pool) th.join();
+}
+
+// SplitMix64 finalizer, used to derive the MinHash permutations from one shingle hash.
+inline uint64_t mixHash(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// One signature per document: entry i is the minimum of permutation i over the
+// document's shingle hashes. Documents shorter than shingleLength get an empty signature.
+inline std::vector<std::vector<uint64_t>> computeMinHashSignatures(const std::vector<std::string>& docs, const CorpusOptions& options) {
+    std::vector<std::vector<uint64_t>> signatures(docs.size());
+    std::vector<uint64_t> seeds(options.numHashes);
+    for (int i = 0; i < options.numHashes; ++i) seeds[i] = mixHash(i);
+    parallelFor(docs.size(), options.threads, [&](size_t doc) {
+        if ((int)docs[doc].length() < options.shingleLength)
+            return;
+        std::vector<uint64_t>& sig = signatures[doc];
+        sig.assign(options.numHashes, UINT64_MAX);
+        RollingHash::forEachWindowHash(docs[doc], options.shingleLength, [&](int, long long hash) {
+            for (int i = 0; i < options.numHashes; ++i) {
+                uint64_t value = mixHash((uint64_t)hash ^ seeds[i]);
+                if (value < sig[i]) sig[i] = value;
+            }
+            return true;
+        });
+    });
+    return signatures;
+}
+
+/**
+ * All-pairs near-duplicate detection over a corpus.
+ * 1. MinHash every document (parallel over documents).
+ * 2. LSH banding: documents whose signatures agree on every row of some band
+ *    become candidate pairs, so dissimilar pairs are never compared.
+ * 3. Candidates are filtered by estimated resemblance and only the survivors
+ *    run the exact longest-common-substring check (parallel over pairs).
+ */
+inline std::vector<NearDuplicatePair> findNearDuplicates(const std::vector<std::string>& docs, const CorpusOptions& options) {
+    std::vector<std::vector<uint64_t>> signatures = computeMinHashSignatures(docs, options);
+    int bands = std::max(1, std::min(options.bands, options.numHashes));
+    int rows = options.numHashes / bands;
+
+    // Bucket (band key, doc) entries per band; equal keys are candidate pairs.
+    // A pair that collides in several bands is recorded once.
+    std::vector<std::pair<int, int>> candidates;
+    std::unordered_set<uint64_t> seen;
+    std::vector<std::pair<uint64_t, int>> bucket;
+    for (int band = 0; band < bands; ++band) {
+        bucket.clear();
+        for (size_t doc = 0; doc < docs.size(); ++doc) {
+            if (signatures[doc].empty()) continue;
+            uint64_t key = mixHash(band);
+            for (int r = band * rows; r < (band + 1) * rows; ++r)
+                key = mixHash(key ^ signatures[doc][r]);
+            bucket.push_back({ key, (int)doc });
+        }
+        std::sort(bucket.begin(), bucket.end());
+        for (size_t i = 0; i < bucket.size();) {
+            size_t j = i;
+            while (j < bucket.size() && bucket[j].first == bucket[i].first) j++;
+            for (size_t x = i; x < j; ++x)
+                for (size_t y = x + 1; y < j; ++y) {
+                    int a = bucket[x].second, b = bucket[y].second; // a < b: bucket is sorted by doc within a key
+                    if (seen.insert(((uint64_t)a << 32) | (uint32_t)b).second)
+                        candidates.push_back({ a, b });
+                }
+            i = j;
+        }
+    }
+    seen = std::unordered_set<uint64_t>();
+    std::sort(candidates.begin(), candidates.end());
+
+    std::vector<NearDuplicatePair> results(candidates.size());
+    std::vector<char> keep(candidates.size(), 0);
+    parallelFor(candidates.size(), options.threads, [&](size_t c) {
+        int a = candidates[c].first, b = candidates[c].second;
+        int equal = 0;
+        for (int i = 0; i < options.numHashes; ++i)
+            equal += signatures[a][i] == signatures[b][i];
+        double estimate = (double)equal / options.numHashes;
+        if (estimate < options.minResemblance)
+            return;
+        results[c] = { a, b, estimate, findLongestMatch(docs[a], docs[b]) };
+        keep[c] = 1;
+    });
+
+    std::vector<NearDuplicatePair> pairs;
+    for (size_t c = 0; c < candidates.size(); ++c)
+        if (keep[c]) pairs.push_back(results[c]);
+    return pairs;
+}
+
+} // namespace stringworks
@@ -0,0 +1,395 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <random>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstdio>
+#include <algorithm>
+
+#include "SuffixArrayDC.h"
+#include "SuffixArrayQuery.h"
+#include "LZFactorization.h"
+#include "ExternalSuffixArray.h"
+#include "CompressedCorpus.h"
+#include "TextSimilarity.h"
+
+using namespace std;
+using namespace stringworks;
+
+// Brute-force equivalence checks for the suffix-array based and similarity engines.
+// Each section is one ctest case: `stringworks_tests <section>` runs it and
+// exits non-zero if any check failed. Inputs come from a fixed seed.
+
+static int failures = 0;
+
+#define CHECK(cond, what)                                                        \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            failures++;                                                          \
+            cerr << __FILE__ << ":" << __LINE__ << ": " << what << endl;         \
+        }                                                                        \
+    } while (0)
+
+// Random text over the first `alphabet` letters; small alphabets give long repeats.
+string randomText(mt19937_64& rng, size_t n, int alphabet) {
+    uniform_int_distribution<int> ch(0, alphabet - 1);
+    string s;
+    for (size_t i = 0; i < n; ++i) s += (char)('a' + ch(rng));
+    return s;
+}
+
+// Texts that stress suffix sorting: random, periodic and a single repeated byte.
+vector<string> sampleTexts(mt19937_64& rng) {
+    vector<string> texts = { "", "a", "banana", "mississippi", "abracadabra" };
+    for (int alphabet : { 1, 2, 4, 26 })
+        for (size_t n : { 7, 64, 500, 3000 })
+            texts.push_back(randomText(rng, n, alphabet));
+    string period = randomText(rng, 13, 4);
+    string periodic;
+    while (periodic.size() < 2000) periodic += period;
+    texts.push_back(periodic);
+    string bytes; // Every byte value, including the ones that are negative as char
+    for (int i = 0; i < 1000; ++i) bytes += (char)(rng() & 0xff);
+    texts.push_back(bytes);
+    return texts;
+}
+
+vector<int> bruteLocate(const string& text, const string& pattern) {
+    vector<int> positions;
+    for (size_t pos = text.find(pattern); pos != string::npos; pos = text.find(pattern, pos + 1))
+        positions.push_back(pos);
+    return positions;
+}
+
+// --- SuffixArrayIndex count / locate / queryBatch ---
+
+void testSuffixArrayQuery() {
+    mt19937_64 rng(31);
+    for (const string& text : sampleTexts(rng)) {
+        if (text.empty()) continue;
+        vector<int> suffixArr = buildSuffixArrayDC(text);
+        vector<int> lcpArr = buildLCPArray(text, suffixArr);
+        SuffixArrayIndex index(text, suffixArr, lcpArr);
+
+        // Substrings of the text, their extensions, and random misses
+        vector<string> patterns;
+        uniform_int_distribution<size_t> pos(0, text.size() - 1);
+        for (int i = 0; i < 200; ++i) {
+            size_t start = pos(rng);
+            size_t len = 1 + rng() % 12;
+            patterns.push_back(text.substr(start, len));
+            if (i % 3 == 0) patterns.push_back(patterns.back() + patterns.back());
+            if (i % 5 == 0) patterns.push_back(randomText(rng, 1 + rng() % 6, 26));
+        }
+        patterns.push_back(patterns.front()); // Duplicate
+
+        vector<vector<int>> expected;
+        for (const string& pattern : patterns) expected.push_back(bruteLocate(text, pattern));
+
+        for (size_t p = 0; p < patterns.size(); ++p) {
+            CHECK(index.count(patterns[p]) == (int)expected[p].size(), "count of '" << patterns[p] << "'");
+            CHECK(index.locate(patterns[p]) == expected[p], "locate of '" << patterns[p] << "'");
+        }
+        for (int threads : { 1, 4 }) {
+            vector<PatternMatches> batch = index.queryBatch(patterns, true, threads);
+            for (size_t p = 0; p < patterns.size(); ++p) {
+                CHECK(batch[p].count == (int)expected[p].size(), "batch count of '" << patterns[p] << "'");
+                CHECK(batch[p].positions == expected[p], "batch locate of '" << patterns[p] << "'");
+            }
+        }
+    }
+}
+
+// --- Prefix-doubling SA, Kasai LCP and LZ77 ---
+
+void testLZ77() {
+    mt19937_64 rng(34);
+    for (const string& text : sampleTexts(rng)) {
+        vector<int> suffixArr = buildSuffixArrayDC(text);
+        CHECK(buildSuffixArrayDoubling(text) == suffixArr, "doubling SA differs, n=" << text.size());
+
+        vector<int> lcpArr = buildLCPArray(text, suffixArr);
+        bool lcpOk = lcpArr.size() == text.size();
+        for (size_t i = 1; lcpOk && i < text.size(); ++i)
+            lcpOk = lcpArr[i] == computeLCP(text, suffixArr[i - 1], suffixArr[i]);
+        CHECK(lcpOk, "Kasai LCP differs, n=" << text.size());
+
+        // Greedy LZ77: each factor is the longest earlier occurrence (overlap allowed)
+        vector<LZFactor> factors = lz77Factorize(text, suffixArr, lcpArr);
+        int pos = 0;
+        for (const LZFactor& f : factors) {
+            int longest = 0;
+            for (int j = 0; j < pos; ++j) longest = max(longest, computeLCP(text, j, pos));
+            if (f.source < 0) {
+                CHECK(longest == 0 && f.literal == text[pos], "literal at " << pos);
+                pos += 1;
+            }
+            else {
+                CHECK(f.source < pos && f.length == longest, "factor length at " << pos);
+                CHECK(computeLCP(text, f.source, pos) >= f.length, "factor source at " << pos);
+                pos += max(f.length, 1);
+            }
+        }
+        CHECK(pos == (int)text.size(), "factors do not cover the text, n=" << text.size());
+
+        string packed = lz77Compress(text);
+        CHECK(lz77Encode(text, factors) == packed, "lz77Compress differs from the DC path");
+        CHECK(lz77Decompress(packed) == text, "round trip, n=" << text.size());
+
+        // Truncated input is rejected rather than read past the end
+        if (packed.size() > 5) {
+            bool threw = false;
+            try { lz77Decompress(packed.substr(0, packed.size() - 1)); }
+            catch (const runtime_error&) { threw = true; }
+            CHECK(threw, "truncated stream accepted, n=" << text.size());
+        }
+    }
+
+    // A huge declared length in a tiny stream is a runtime_error, not a huge allocation
+    for (const string& header : { string("LZ77\xff\xff\xff\xff\xff\xff\xff\xff\x7f", 13),
+                                  string("LZ77\x80\x80\x80\x80\x10\x02x", 11) }) {
+        bool threw = false;
+        try { lz77Decompress(header); }
+        catch (const runtime_error&) { threw = true; }
+        CHECK(threw, "oversized length accepted");
+    }
+}
+
+// --- Disk-backed SA / LCP / BWT ---
+
+template <typename T>
+vector<T> readFile(const string& path) {
+    ifstream in(path, ios::binary);
+    vector<T> values;
+    T value;
+    while (in.read(reinterpret_cast<char*>(&value), sizeof(value))) values.push_back(value);
+    return values;
+}
+
+void testExternalSuffixArray() {
+    mt19937_64 rng(32);
+    vector<string> texts = sampleTexts(rng);
+    texts.push_back("already terminated$");
+    texts.push_back(randomText(rng, 20000, 4)); // Many runs and merge passes under the small budget
+
+    const string input = "equivalence_external_input.tmp";
+    const string prefix = "equivalence_external";
+    for (const string& text : texts) {
+        ofstream(input, ios::binary) << text;
+        string withSentinel = !text.empty() && text.back() == '$' ? text : text + "$";
+        vector<int> suffixArr = buildSuffixArrayDC(withSentinel);
+        vector<int> lcpArr = buildLCPArray(withSentinel, suffixArr);
+        string bwt = buildBWT(withSentinel, suffixArr);
+
+        for (size_t budget : { size_t(1) << 10, size_t(64) << 20 }) {
+            ExternalBuildOptions options;
+            options.ramBudgetBytes = budget;
+            options.maxFanIn = 2;
+            buildSuffixArrayExternal(input, prefix, options);
+
+            vector<int64_t> sa = readFile<int64_t>(prefix + ".sa");
+            vector<int64_t> lcp = readFile<int64_t>(prefix + ".lcp");
+            vector<char> bwtOut = readFile<char>(prefix + ".bwt");
+            CHECK(sa == vector<int64_t>(suffixArr.begin(), suffixArr.end()), "external SA, n=" << text.size() << " budget=" << budget);
+            CHECK(lcp == vector<int64_t>(lcpArr.begin(), lcpArr.end()), "external LCP, n=" << text.size() << " budget=" << budget);
+            CHECK(string(bwtOut.begin(), bwtOut.end()) == bwt, "external BWT, n=" << text.size() << " budget=" << budget);
+        }
+    }
+    for (const char* suffix : { ".sa", ".lcp", ".bwt" }) remove((prefix + suffix).c_str());
+    remove(input.c_str());
+}
+
+// --- Compressed corpus: FM-index search and decompression ---
+
+string readAll(const string& path) {
+    ifstream in(path, ios::binary);
+    return string((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+}
+
+void testCompressedCorpus() {
+    mt19937_64 rng(33);
+    string corpus;
+    for (const string& text : sampleTexts(rng)) corpus += text;
+    const string path = "equivalence_corpus.tmp";
+
+    // Small blocks and segments so searches cross block and segment boundaries
+    CorpusBuildOptions small;
+    small.blockSize = 1500;
+    small.overlap = 31;
+    small.segmentRows = 100;
+    for (const CorpusBuildOptions& options : { small, CorpusBuildOptions() }) {
+        istringstream in(corpus);
+        writeCompressedCorpus(in, path, options);
+        CompressedCorpus packed(path);
+        CHECK(packed.length() == corpus.size(), "corpus length");
+        CHECK(packed.decompress() == corpus, "decompress, blockSize=" << options.blockSize);
+
+        vector<string> patterns = { "a", "ab", "banana", "zzzzzzzz", string(1, '\xff') };
+        uniform_int_distribution<size_t> pos(0, corpus.size() - 1);
+        for (int i = 0; i < 100; ++i) {
+            size_t len = 1 + rng() % packed.maxPatternLength();
+            patterns.push_back(corpus.substr(pos(rng), len));
+        }
+        for (const string& pattern : patterns) {
+            CorpusSearchResult result = packed.search(pattern);
+            vector<int64_t> expected;
+            for (int p : bruteLocate(corpus, pattern)) expected.push_back(p);
+            CHECK(result.positions == expected, "search for a " << pattern.size() << "-byte pattern");
+            CHECK(result.blocksSkipped + result.blocksRead == packed.blockCount(), "block accounting");
+        }
+    }
+
+    // Every single-byte corruption is either harmless or a runtime_error
+    istringstream in(corpus.substr(0, 3000));
+    writeCompressedCorpus(in, path, small);
+    string archive = readAll(path);
+    int rejected = 0;
+    for (size_t i = 0; i < archive.size(); ++i) {
+        string damaged = archive;
+        damaged[i] ^= (char)(1 + rng() % 255);
+        ofstream(path, ios::binary | ios::trunc) << damaged;
+        try {
+            CompressedCorpus packed(path);
+            packed.decompress();
+            packed.search("ab");
+        }
+        catch (const runtime_error&) {
+            rejected++;
+        }
+    }
+    CHECK(rejected > 0, "no corruption was detected");
+    remove(path.c_str());
+}
+
+// --- Text similarity: longest match, maximal matches, near-duplicates ---
+
+// Longest common substring by dynamic programming over (i, j) suffix pairs.
+int bruteLongestMatch(const string& a, const string& b) {
+    int best = 0;
+    vector<int> row(b.size() + 1, 0), next(b.size() + 1, 0);
+    for (size_t i = a.size(); i-- > 0;) {
+        for (size_t j = b.size(); j-- > 0;) {
+            next[j] = a[i] == b[j] ? row[j + 1] + 1 : 0;
+            best = max(best, next[j]);
+        }
+        swap(row, next);
+    }
+    return best;
+}
+
+// Every maximal common substring of at least minLength, in compare()'s order.
+vector<CommonSubstring> bruteMaximalMatches(const string& a, const string& b, int minLength) {
+    vector<CommonSubstring> matches;
+    for (int i = 0; i < (int)a.size(); ++i) {
+        for (int j = 0; j < (int)b.size(); ++j) {
+            if (i > 0 && j > 0 && a[i - 1] == b[j - 1]) continue; // Not left-maximal
+            int len = 0;
+            while (i + len < (int)a.size() && j + len < (int)b.size() && a[i + len] == b[j + len]) len++;
+            if (len >= minLength) matches.push_back({ i, j, len });
+        }
+    }
+    sort(matches.begin(), matches.end(), [](const CommonSubstring& x, const CommonSubstring& y) {
+        if (x.length != y.length) return x.length > y.length;
+        if (x.posA != y.posA) return x.posA < y.posA;
+        return x.posB < y.posB;
+    });
+    return matches;
+}
+
+bool sameMatches(const vector<CommonSubstring>& x, const vector<CommonSubstring>& y) {
+    if (x.size() != y.size()) return false;
+    for (size_t i = 0; i < x.size(); ++i)
+        if (x[i].posA != y[i].posA || x[i].posB != y[i].posB || x[i].length != y[i].length) return false;
+    return true;
+}
+
+void testSimilarity() {
+    mt19937_64 rng(26);
+    for (int trial = 0; trial < 400; ++trial) {
+        int alphabet = 1 + trial % 4;
+        string a = randomText(rng, rng() % 80, alphabet);
+        string b = randomText(rng, rng() % 80, alphabet);
+        if (trial % 5 == 0 && !a.empty()) b += a.substr(rng() % a.size()); // Plant a shared tail
+
+        CHECK(findLongestMatch(a, b) == bruteLongestMatch(a, b), "longest match, |A|=" << a.size() << " |B|=" << b.size());
+
+        int minLength = 1 + trial % 6;
+        DocumentIndex index(a, minLength);
+        vector<CommonSubstring> expected = bruteMaximalMatches(a, b, minLength);
+        SimilarityReport report = index.compare(b);
+        CHECK(sameMatches(report.matches, expected), "maximal matches, trial " << trial << " minLength=" << minLength);
+        CHECK(report.longest == (expected.empty() ? 0 : expected[0].length), "report.longest, trial " << trial);
+
+        // topK keeps the first k of the full order
+        for (size_t topK : { 1, 3, 1000 }) {
+            vector<CommonSubstring> cut(expected.begin(), expected.begin() + min(topK, expected.size()));
+            CHECK(sameMatches(index.compare(b, topK).matches, cut), "topK=" << topK << ", trial " << trial);
+        }
+    }
+
+    // Planted near-duplicates: each copy differs from its original in a few bytes
+    vector<string> docs;
+    vector<pair<int, int>> planted;
+    for (int d = 0; d < 40; ++d) docs.push_back(randomText(rng, 400, 26));
+    for (int d = 0; d < 10; ++d) {
+        string copy = docs[d * 3];
+        for (int k = 0; k < 3; ++k) copy[rng() % copy.size()] = 'a' + rng() % 26;
+        planted.push_back({ d * 3, (int)docs.size() });
+        docs.push_back(copy);
+    }
+
+    CorpusOptions serial;
+    serial.threads = 1;
+    CorpusOptions parallel; // Default thread count
+    CorpusOptions forced;
+    forced.threads = 4;     // More workers than pairs per thread on small machines
+    vector<NearDuplicatePair> expected = findNearDuplicates(docs, serial);
+    for (const pair<int, int>& p : planted) {
+        bool found = false;
+        for (const NearDuplicatePair& pair : expected) found = found || (pair.docA == p.first && pair.docB == p.second);
+        CHECK(found, "planted pair (" << p.first << ", " << p.second << ") not reported");
+    }
+    for (const NearDuplicatePair& pair : expected)
+        CHECK(pair.longestMatch == bruteLongestMatch(docs[pair.docA], docs[pair.docB]), "pair longest match");
+
+    for (const CorpusOptions& options : { parallel, forced }) {
+        vector<NearDuplicatePair> pairs = findNearDuplicates(docs, options);
+        bool same = pairs.size() == expected.size();
+        for (size_t i = 0; same && i < pairs.size(); ++i) {
+            same = pairs[i].docA == expected[i].docA && pairs[i].docB == expected[i].docB
+                && pairs[i].estimatedResemblance == expected[i].estimatedResemblance
+                && pairs[i].longestMatch == expected[i].longestMatch;
+        }
+        CHECK(same, "near-duplicates with threads=" << options.threads << " differ from threads=1");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const map<string, function<void()>> sections = {
+        { "sa-query", testSuffixArrayQuery },
+        { "lz77", testLZ77 },
+        { "external-sa", testExternalSuffixArray },
+        { "fm-search", testCompressedCorpus },
+        { "similarity", testSimilarity },
+    };
+    vector<string> names;
+    for (int i = 1; i < argc; ++i) names.push_back(argv[i]);
+    if (names.empty())
+        for (const auto& section : sections) names.push_back(section.first);
+
+    for (const string& name : names) {
+        auto it = sections.find(name);
+        if (it == sections.end()) {
+            cerr << "Unknown section: " << name << endl;
+            return 2;
+        }
+        int before = failures;
+        it->second();
+        cout << name << ": " << (failures == before ? "ok" : "FAILED") << endl;
+    }
+    return failures == 0 ? 0 : 1;
+}